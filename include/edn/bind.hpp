@@ -0,0 +1,348 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace edn
+{
+
+namespace detail
+{
+
+template <class... Ts>
+struct type_list
+{
+};
+
+template <class F>
+struct function_traits : function_traits<decltype(&F::operator())>
+{
+};
+
+template <class R, class... Args>
+struct function_traits<R (*)(Args...)>
+{
+    using signature = type_list<R, Args...>;
+    static constexpr std::size_t arity = sizeof...(Args);
+};
+
+template <class R, class... Args>
+struct function_traits<R (*)(Args...) noexcept> : function_traits<R (*)(Args...)>
+{
+};
+
+template <class R, class C, class... Args>
+struct function_traits<R (C::*)(Args...)> : function_traits<R (*)(Args...)>
+{
+};
+
+template <class R, class C, class... Args>
+struct function_traits<R (C::*)(Args...) const> : function_traits<R (*)(Args...)>
+{
+};
+
+template <class R, class C, class... Args>
+struct function_traits<R (C::*)(Args...) noexcept> : function_traits<R (*)(Args...)>
+{
+};
+
+template <class R, class C, class... Args>
+struct function_traits<R (C::*)(Args...) const noexcept> : function_traits<R (*)(Args...)>
+{
+};
+
+template <class T>
+constexpr bool dependent_false = false;
+
+// Whether `value` is representable in `To`, without relying on comparisons that are trivially true for some types.
+template <class To, class From>
+constexpr bool in_range(From value)
+{
+    constexpr bool widening = std::numeric_limits<To>::digits >= std::numeric_limits<From>::digits;
+    if constexpr (std::is_signed_v<From> == std::is_signed_v<To>)
+    {
+        if constexpr (widening)
+        {
+            return true;
+        }
+        else
+        {
+            return value >= static_cast<From>(std::numeric_limits<To>::min())
+                   && value <= static_cast<From>(std::numeric_limits<To>::max());
+        }
+    }
+    else if constexpr (std::is_signed_v<From>)
+    {
+        if (value < 0)
+        {
+            return false;
+        }
+        if constexpr (widening)
+        {
+            return true;
+        }
+        else
+        {
+            return value <= static_cast<From>(std::numeric_limits<To>::max());
+        }
+    }
+    else
+    {
+        if constexpr (widening)
+        {
+            return true;
+        }
+        else
+        {
+            return value <= static_cast<From>(std::numeric_limits<To>::max());
+        }
+    }
+}
+
+[[noreturn]] inline void throw_argument_error(std::size_t index, value_type_t expected, const value_t& actual)
+{
+    throw std::runtime_error{ str("argument ", index + 1, ": expected ", expected, ", got ", actual.type()) };
+}
+
+template <class T, class = void>
+struct argument_traits
+{
+    static_assert(dependent_false<T>, "unsupported parameter type for edn::bind");
+};
+
+template <>
+struct argument_traits<value_t>
+{
+    static const value_t& get(const value_t& value, std::size_t) { return value; }
+};
+
+// Parameters naming one of the value alternatives bind to the element stored in the argument, without copying it.
+template <class T, const T* (value_t::*Accessor)() const, value_type_t Type>
+struct reference_argument
+{
+    static const T& get(const value_t& value, std::size_t index)
+    {
+        if (const T* ptr = (value.*Accessor)())
+        {
+            return *ptr;
+        }
+        throw_argument_error(index, Type, value);
+    }
+};
+
+template <>
+struct argument_traits<boolean_t> : reference_argument<boolean_t, &value_t::if_boolean, value_type_t::boolean>
+{
+};
+
+template <>
+struct argument_traits<character_t> : reference_argument<character_t, &value_t::if_character, value_type_t::character>
+{
+};
+
+template <>
+struct argument_traits<string_t> : reference_argument<string_t, &value_t::if_string, value_type_t::string>
+{
+};
+
+template <>
+struct argument_traits<symbol_t> : reference_argument<symbol_t, &value_t::if_symbol, value_type_t::symbol>
+{
+};
+
+template <>
+struct argument_traits<keyword_t> : reference_argument<keyword_t, &value_t::if_keyword, value_type_t::keyword>
+{
+};
+
+template <>
+struct argument_traits<vector_t> : reference_argument<vector_t, &value_t::if_vector, value_type_t::vector>
+{
+};
+
+template <>
+struct argument_traits<list_t> : reference_argument<list_t, &value_t::if_list, value_type_t::list>
+{
+};
+
+template <>
+struct argument_traits<set_t> : reference_argument<set_t, &value_t::if_set, value_type_t::set>
+{
+};
+
+template <>
+struct argument_traits<map_t> : reference_argument<map_t, &value_t::if_map, value_type_t::map>
+{
+};
+
+template <>
+struct argument_traits<sorted_set_t>
+    : reference_argument<sorted_set_t, &value_t::if_sorted_set, value_type_t::sorted_set>
+{
+};
+
+template <>
+struct argument_traits<sorted_map_t>
+    : reference_argument<sorted_map_t, &value_t::if_sorted_map, value_type_t::sorted_map>
+{
+};
+
+template <>
+struct argument_traits<tagged_element_t>
+    : reference_argument<tagged_element_t, &value_t::if_tagged_element, value_type_t::tagged_element>
+{
+};
+
+template <>
+struct argument_traits<quoted_element_t>
+    : reference_argument<quoted_element_t, &value_t::if_quoted_element, value_type_t::quoted_element>
+{
+};
+
+template <>
+struct argument_traits<callable_t> : reference_argument<callable_t, &value_t::if_callable, value_type_t::callable>
+{
+};
+
+template <>
+struct argument_traits<atom_t> : reference_argument<atom_t, &value_t::if_atom, value_type_t::atom>
+{
+};
+
+template <>
+struct argument_traits<future_t> : reference_argument<future_t, &value_t::if_future, value_type_t::future>
+{
+};
+
+template <>
+struct argument_traits<std::string_view>
+{
+    static std::string_view get(const value_t& value, std::size_t index)
+    {
+        return argument_traits<string_t>::get(value, index);
+    }
+};
+
+template <class T>
+struct argument_traits<
+    T,
+    std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, boolean_t> && !std::is_same_v<T, character_t>>>
+{
+    static T get(const value_t& value, std::size_t index)
+    {
+        const integer_t* ptr = value.if_integer();
+        if (!ptr)
+        {
+            throw_argument_error(index, value_type_t::integer, value);
+        }
+        if (!in_range<T>(*ptr))
+        {
+            throw std::out_of_range{ str("argument ", index + 1, ": ", *ptr, " is out of range") };
+        }
+        return static_cast<T>(*ptr);
+    }
+};
+
+template <class T>
+struct argument_traits<T, std::enable_if_t<std::is_floating_point_v<T>>>
+{
+    static T get(const value_t& value, std::size_t index)
+    {
+        if (const floating_point_t* ptr = value.if_floating_point())
+        {
+            return static_cast<T>(*ptr);
+        }
+        if (const integer_t* ptr = value.if_integer())
+        {
+            return static_cast<T>(*ptr);
+        }
+        throw_argument_error(index, value_type_t::floating_point, value);
+    }
+};
+
+// `nil` maps to an empty optional.
+template <class T>
+struct argument_traits<std::optional<T>>
+{
+    static std::optional<T> get(const value_t& value, std::size_t index)
+    {
+        if (value.is_nil())
+        {
+            return std::nullopt;
+        }
+        return argument_traits<T>::get(value, index);
+    }
+};
+
+template <class T>
+value_t to_value(T&& result)
+{
+    using type = std::decay_t<T>;
+    if constexpr (std::is_same_v<type, value_t>)
+    {
+        return std::forward<T>(result);
+    }
+    else if constexpr (
+        std::is_integral_v<type> && !std::is_same_v<type, boolean_t> && !std::is_same_v<type, character_t>)
+    {
+        if (!in_range<integer_t>(result))
+        {
+            throw std::out_of_range{ str("result ", result, " is out of range") };
+        }
+        return static_cast<integer_t>(result);
+    }
+    else if constexpr (std::is_floating_point_v<type>)
+    {
+        return static_cast<floating_point_t>(result);
+    }
+    else if constexpr (std::is_same_v<type, std::string_view>)
+    {
+        return string_t{ result };
+    }
+    else
+    {
+        return value_t{ std::forward<T>(result) };
+    }
+}
+
+template <class Func, class R, class... Args, std::size_t... I>
+value_t invoke_bound(Func& func, const std::vector<value_t>& args, type_list<R, Args...>, std::index_sequence<I...>)
+{
+    if (args.size() != sizeof...(Args))
+    {
+        throw std::runtime_error{ str("expected ", sizeof...(Args), " argument(s), got ", args.size()) };
+    }
+    if constexpr (std::is_void_v<R>)
+    {
+        func(argument_traits<std::decay_t<Args>>::get(args[I], I)...);
+        return nil;
+    }
+    else
+    {
+        return to_value(func(argument_traits<std::decay_t<Args>>::get(args[I], I)...));
+    }
+}
+
+}  // namespace detail
+
+// Wraps a function with typed parameters into a callable_t. Arity and argument types are checked when called;
+// arguments are unboxed straight from the argument vector (by reference for strings and collections), integers are
+// range-checked against narrower parameter types and accepted where floating point is expected.
+template <class Func>
+callable_t bind(Func func)
+{
+    using traits = detail::function_traits<std::decay_t<Func>>;
+    return callable_t{ [func = std::move(func)](const std::vector<value_t>& args) mutable -> value_t
+                       {
+                           return detail::invoke_bound(
+                               func, args, typename traits::signature{}, std::make_index_sequence<traits::arity>{});
+                       } };
+}
+
+}  // namespace edn
@@ -0,0 +1,598 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace edn
+{
+
+// Test applied to keys by range queries, in the manner of Clojure's `subseq`: `gt` selects keys greater than the bound.
+enum class range_test
+{
+    lt,
+    le,
+    gt,
+    ge
+};
+
+template <class Iterator>
+struct range_t
+{
+    Iterator m_begin;
+    Iterator m_end;
+
+    Iterator begin() const { return m_begin; }
+    Iterator end() const { return m_end; }
+    bool empty() const { return m_begin == m_end; }
+};
+
+namespace detail
+{
+
+// In-memory B-tree of unique entries. `KeyOf` extracts the key of an entry and `Compare` is a three-way comparison
+// of keys returning a negative, zero or positive int. Each node holds between `Degree - 1` and `2 * Degree - 1`
+// entries (the root may hold fewer) in one contiguous array, so a lookup touches O(log n / log Degree) nodes.
+template <class Entry, class KeyOf, class Compare, std::size_t Degree = 16>
+class btree
+{
+    static_assert(Degree >= 2, "B-tree degree must be at least 2");
+
+    static constexpr std::size_t max_entries = 2 * Degree - 1;
+    static constexpr std::size_t min_entries = Degree - 1;
+
+    struct node_t
+    {
+        std::vector<Entry> entries;
+        std::vector<std::unique_ptr<node_t>> children;
+
+        node_t() { entries.reserve(max_entries); }
+
+        bool is_leaf() const { return children.empty(); }
+
+        bool is_full() const { return entries.size() == max_entries; }
+
+        std::unique_ptr<node_t> clone() const
+        {
+            auto result = std::make_unique<node_t>();
+            result->entries = entries;
+            result->children.reserve(children.size());
+            for (const auto& child : children)
+            {
+                result->children.push_back(child->clone());
+            }
+            return result;
+        }
+    };
+
+public:
+    using entry_type = Entry;
+    using key_type = std::decay_t<decltype(KeyOf{}(std::declval<const Entry&>()))>;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry*;
+        using reference = const Entry&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return m_path.back().first->entries[m_path.back().second]; }
+        pointer operator->() const { return &**this; }
+
+        const_iterator& operator++()
+        {
+            auto& [node, index] = m_path.back();
+            if (!node->is_leaf())
+            {
+                // Descend into the subtree right of the current entry; the frame now records the child index.
+                index += 1;
+                push_leftmost(node->children[index].get());
+                return *this;
+            }
+            if (index + 1 < node->entries.size())
+            {
+                index += 1;
+                return *this;
+            }
+            m_path.pop_back();
+            while (!m_path.empty() && m_path.back().second == m_path.back().first->entries.size())
+            {
+                m_path.pop_back();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        const_iterator& operator--()
+        {
+            if (m_path.empty())
+            {
+                push_rightmost(m_tree->m_root.get());
+                return *this;
+            }
+            auto& [node, index] = m_path.back();
+            if (!node->is_leaf())
+            {
+                push_rightmost(node->children[index].get());
+                return *this;
+            }
+            if (index > 0)
+            {
+                index -= 1;
+                return *this;
+            }
+            m_path.pop_back();
+            while (!m_path.empty() && m_path.back().second == 0)
+            {
+                m_path.pop_back();
+            }
+            if (!m_path.empty())
+            {
+                m_path.back().second -= 1;
+            }
+            return *this;
+        }
+
+        const_iterator operator--(int)
+        {
+            const_iterator result = *this;
+            --*this;
+            return result;
+        }
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs)
+        {
+            if (lhs.m_path.empty() || rhs.m_path.empty())
+            {
+                return lhs.m_path.empty() && rhs.m_path.empty();
+            }
+            return lhs.m_path.back() == rhs.m_path.back();
+        }
+
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) { return !(lhs == rhs); }
+
+    private:
+        friend class btree;
+
+        // Root-to-current path. The last frame indexes the current entry; the others index the child descended into.
+        std::vector<std::pair<const node_t*, std::size_t>> m_path;
+        const btree* m_tree = nullptr;
+
+        explicit const_iterator(const btree* tree) : m_tree(tree) { }
+
+        void push_leftmost(const node_t* node)
+        {
+            while (true)
+            {
+                m_path.emplace_back(node, 0);
+                if (node->is_leaf())
+                {
+                    return;
+                }
+                node = node->children.front().get();
+            }
+        }
+
+        void push_rightmost(const node_t* node)
+        {
+            while (true)
+            {
+                if (node->is_leaf())
+                {
+                    m_path.emplace_back(node, node->entries.size() - 1);
+                    return;
+                }
+                m_path.emplace_back(node, node->children.size() - 1);
+                node = node->children.back().get();
+            }
+        }
+
+        // Moves from a position past the last entry of a leaf to the next entry in order.
+        void normalize()
+        {
+            while (!m_path.empty() && m_path.back().second == m_path.back().first->entries.size())
+            {
+                m_path.pop_back();
+            }
+        }
+    };
+
+    using iterator = const_iterator;
+
+    btree() = default;
+
+    btree(const btree& other) : m_root(other.m_root ? other.m_root->clone() : nullptr), m_size(other.m_size) { }
+
+    btree(btree&&) noexcept = default;
+
+    btree& operator=(btree other) noexcept
+    {
+        std::swap(m_root, other.m_root);
+        std::swap(m_size, other.m_size);
+        return *this;
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const_iterator begin() const
+    {
+        const_iterator result{ this };
+        if (!empty())
+        {
+            result.push_leftmost(m_root.get());
+        }
+        return result;
+    }
+
+    const_iterator end() const { return const_iterator{ this }; }
+
+    // First entry whose key is not less than `key`.
+    const_iterator lower_bound(const key_type& key) const
+    {
+        return bound(key, [](int cmp) { return cmp > 0; }, true);
+    }
+
+    // First entry whose key is greater than `key`.
+    const_iterator upper_bound(const key_type& key) const
+    {
+        return bound(key, [](int cmp) { return cmp >= 0; }, false);
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        const const_iterator it = lower_bound(key);
+        return it != end() && m_compare(key, m_key_of(*it)) == 0 ? it : end();
+    }
+
+    bool contains(const key_type& key) const { return find(key) != end(); }
+
+    // Entries whose keys satisfy `test` against `key`, in ascending order.
+    range_t<const_iterator> subseq(range_test test, const key_type& key) const
+    {
+        switch (test)
+        {
+            case range_test::lt: return { begin(), lower_bound(key) };
+            case range_test::le: return { begin(), upper_bound(key) };
+            case range_test::gt: return { upper_bound(key), end() };
+            case range_test::ge: return { lower_bound(key), end() };
+        }
+        return { end(), end() };
+    }
+
+    // Entries with keys between the two bounds; `start_test` is `gt` or `ge` and `end_test` is `lt` or `le`.
+    range_t<const_iterator> subseq(
+        range_test start_test, const key_type& start_key, range_test end_test, const key_type& end_key) const
+    {
+        const_iterator first = subseq(start_test, start_key).begin();
+        const const_iterator last = subseq(end_test, end_key).end();
+        if (first == end() || (last != end() && m_compare(m_key_of(*first), m_key_of(*last)) > 0))
+        {
+            first = last;
+        }
+        return { first, last };
+    }
+
+    // As `subseq`, in descending order.
+    range_t<std::reverse_iterator<const_iterator>> rsubseq(range_test test, const key_type& key) const
+    {
+        return reversed(subseq(test, key));
+    }
+
+    range_t<std::reverse_iterator<const_iterator>> rsubseq(
+        range_test start_test, const key_type& start_key, range_test end_test, const key_type& end_key) const
+    {
+        return reversed(subseq(start_test, start_key, end_test, end_key));
+    }
+
+    // Inserts `entry`, or replaces the entry with an equal key. Returns true if the tree grew.
+    bool insert_or_assign(Entry entry)
+    {
+        if (!m_root)
+        {
+            m_root = std::make_unique<node_t>();
+        }
+        if (m_root->is_full())
+        {
+            auto root = std::make_unique<node_t>();
+            root->children.push_back(std::move(m_root));
+            m_root = std::move(root);
+            split_child(*m_root, 0);
+        }
+        const bool inserted = insert_non_full(*m_root, std::move(entry));
+        m_size += inserted ? 1 : 0;
+        return inserted;
+    }
+
+    bool erase(const key_type& key)
+    {
+        if (!m_root)
+        {
+            return false;
+        }
+        const bool erased = erase(*m_root, key);
+        if (m_root->entries.empty())
+        {
+            m_root = m_root->is_leaf() ? nullptr : std::move(m_root->children.front());
+        }
+        m_size -= erased ? 1 : 0;
+        return erased;
+    }
+
+    struct node_memory_t
+    {
+        std::size_t structure_bytes = 0;
+        std::size_t slack_bytes = 0;
+    };
+
+    // Heap bytes of the nodes apart from the entries: node headers and child pointers, and unused vector capacity.
+    node_memory_t node_memory() const
+    {
+        node_memory_t result = {};
+        std::vector<const node_t*> pending = {};
+        if (m_root)
+        {
+            pending.push_back(m_root.get());
+        }
+        while (!pending.empty())
+        {
+            const node_t* node = pending.back();
+            pending.pop_back();
+            result.structure_bytes += sizeof(node_t) + node->children.size() * sizeof(std::unique_ptr<node_t>);
+            result.slack_bytes += (node->entries.capacity() - node->entries.size()) * sizeof(Entry)
+                                  + (node->children.capacity() - node->children.size()) * sizeof(std::unique_ptr<node_t>);
+            for (const auto& child : node->children)
+            {
+                pending.push_back(child.get());
+            }
+        }
+        return result;
+    }
+
+protected:
+    // Entry with the given key, for derived containers that update the non-key part of an entry in place.
+    Entry* find_entry(const key_type& key)
+    {
+        node_t* node = m_root.get();
+        while (node)
+        {
+            const auto [index, found] = search(*node, key);
+            if (found)
+            {
+                return &node->entries[index];
+            }
+            node = node->is_leaf() ? nullptr : node->children[index].get();
+        }
+        return nullptr;
+    }
+
+private:
+    static range_t<std::reverse_iterator<const_iterator>> reversed(const range_t<const_iterator>& range)
+    {
+        return { std::reverse_iterator<const_iterator>{ range.end() },
+                 std::reverse_iterator<const_iterator>{ range.begin() } };
+    }
+
+    std::unique_ptr<node_t> m_root;
+    std::size_t m_size = 0;
+    KeyOf m_key_of = {};
+    Compare m_compare = {};
+
+    // Index of the first entry in `node` that is not less than `key`, and whether that entry is equal to it.
+    std::pair<std::size_t, bool> search(const node_t& node, const key_type& key) const
+    {
+        std::size_t lo = 0;
+        std::size_t hi = node.entries.size();
+        while (lo < hi)
+        {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (m_compare(m_key_of(node.entries[mid]), key) < 0)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return { lo, lo < node.entries.size() && m_compare(key, m_key_of(node.entries[lo])) == 0 };
+    }
+
+    // Descends towards `key`; within a node, skips the entries for which `before(compare(key, entry))` holds.
+    template <class Before>
+    const_iterator bound(const key_type& key, Before before, bool stop_on_equal) const
+    {
+        const_iterator result{ this };
+        const node_t* node = m_root.get();
+        while (node)
+        {
+            std::size_t lo = 0;
+            std::size_t hi = node->entries.size();
+            while (lo < hi)
+            {
+                const std::size_t mid = lo + (hi - lo) / 2;
+                if (before(m_compare(key, m_key_of(node->entries[mid]))))
+                {
+                    lo = mid + 1;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            result.m_path.emplace_back(node, lo);
+            if (stop_on_equal && lo < node->entries.size() && m_compare(key, m_key_of(node->entries[lo])) == 0)
+            {
+                return result;
+            }
+            node = node->is_leaf() ? nullptr : node->children[lo].get();
+        }
+        result.normalize();
+        return result;
+    }
+
+    void split_child(node_t& parent, std::size_t index)
+    {
+        node_t& child = *parent.children[index];
+        auto sibling = std::make_unique<node_t>();
+        sibling->entries.assign(
+            std::make_move_iterator(child.entries.begin() + Degree), std::make_move_iterator(child.entries.end()));
+        if (!child.is_leaf())
+        {
+            sibling->children.assign(
+                std::make_move_iterator(child.children.begin() + Degree), std::make_move_iterator(child.children.end()));
+            child.children.erase(child.children.begin() + Degree, child.children.end());
+        }
+        parent.entries.insert(
+            parent.entries.begin() + static_cast<std::ptrdiff_t>(index), std::move(child.entries[Degree - 1]));
+        child.entries.erase(child.entries.begin() + Degree - 1, child.entries.end());
+        parent.children.insert(parent.children.begin() + static_cast<std::ptrdiff_t>(index) + 1, std::move(sibling));
+    }
+
+    bool insert_non_full(node_t& node, Entry&& entry)
+    {
+        auto [index, found] = search(node, m_key_of(entry));
+        if (found)
+        {
+            node.entries[index] = std::move(entry);
+            return false;
+        }
+        if (node.is_leaf())
+        {
+            node.entries.insert(node.entries.begin() + static_cast<std::ptrdiff_t>(index), std::move(entry));
+            return true;
+        }
+        if (node.children[index]->is_full())
+        {
+            split_child(node, index);
+            const int cmp = m_compare(m_key_of(entry), m_key_of(node.entries[index]));
+            if (cmp == 0)
+            {
+                node.entries[index] = std::move(entry);
+                return false;
+            }
+            index += cmp > 0 ? 1 : 0;
+        }
+        return insert_non_full(*node.children[index], std::move(entry));
+    }
+
+    // Merges child `index + 1` and the separating entry into child `index`.
+    void merge_children(node_t& node, std::size_t index)
+    {
+        node_t& left = *node.children[index];
+        std::unique_ptr<node_t> right = std::move(node.children[index + 1]);
+        left.entries.push_back(std::move(node.entries[index]));
+        left.entries.insert(
+            left.entries.end(),
+            std::make_move_iterator(right->entries.begin()),
+            std::make_move_iterator(right->entries.end()));
+        left.children.insert(
+            left.children.end(),
+            std::make_move_iterator(right->children.begin()),
+            std::make_move_iterator(right->children.end()));
+        node.entries.erase(node.entries.begin() + static_cast<std::ptrdiff_t>(index));
+        node.children.erase(node.children.begin() + static_cast<std::ptrdiff_t>(index) + 1);
+    }
+
+    // Makes sure child `index` holds more than the minimum number of entries before descending into it; returns the
+    // index of the child to descend into, which moves left when the child is merged into its left sibling.
+    std::size_t fill_child(node_t& node, std::size_t index)
+    {
+        node_t& child = *node.children[index];
+        if (child.entries.size() > min_entries)
+        {
+            return index;
+        }
+        if (index > 0 && node.children[index - 1]->entries.size() > min_entries)
+        {
+            node_t& left = *node.children[index - 1];
+            child.entries.insert(child.entries.begin(), std::move(node.entries[index - 1]));
+            node.entries[index - 1] = std::move(left.entries.back());
+            left.entries.pop_back();
+            if (!left.is_leaf())
+            {
+                child.children.insert(child.children.begin(), std::move(left.children.back()));
+                left.children.pop_back();
+            }
+            return index;
+        }
+        if (index < node.entries.size() && node.children[index + 1]->entries.size() > min_entries)
+        {
+            node_t& right = *node.children[index + 1];
+            child.entries.push_back(std::move(node.entries[index]));
+            node.entries[index] = std::move(right.entries.front());
+            right.entries.erase(right.entries.begin());
+            if (!right.is_leaf())
+            {
+                child.children.push_back(std::move(right.children.front()));
+                right.children.erase(right.children.begin());
+            }
+            return index;
+        }
+        if (index < node.entries.size())
+        {
+            merge_children(node, index);
+            return index;
+        }
+        merge_children(node, index - 1);
+        return index - 1;
+    }
+
+    bool erase(node_t& node, const key_type& key)
+    {
+        const auto [index, found] = search(node, key);
+        if (node.is_leaf())
+        {
+            if (found)
+            {
+                node.entries.erase(node.entries.begin() + static_cast<std::ptrdiff_t>(index));
+            }
+            return found;
+        }
+        if (!found)
+        {
+            return erase(*node.children[fill_child(node, index)], key);
+        }
+        // Swap the entry with its in-order predecessor or successor, which keeps the tree ordered, then remove it
+        // from the leaf level of that subtree.
+        if (node.children[index]->entries.size() > min_entries)
+        {
+            node_t* pred = node.children[index].get();
+            while (!pred->is_leaf())
+            {
+                pred = pred->children.back().get();
+            }
+            std::swap(node.entries[index], pred->entries.back());
+            return erase(*node.children[index], key);
+        }
+        if (node.children[index + 1]->entries.size() > min_entries)
+        {
+            node_t* succ = node.children[index + 1].get();
+            while (!succ->is_leaf())
+            {
+                succ = succ->children.front().get();
+            }
+            std::swap(node.entries[index], succ->entries.front());
+            return erase(*node.children[index + 1], key);
+        }
+        merge_children(node, index);
+        return erase(*node.children[index], key);
+    }
+};
+
+}  // namespace detail
+
+}  // namespace edn
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace edn
+{
+
+namespace detail
+{
+
+// Two 64-bit lanes over a stream of words, each lane finalized by the splitmix64 mixer. Not cryptographic; 128 bits
+// make accidental collisions negligible for cache keys and identity checks.
+class hasher_t
+{
+public:
+    void add(std::uint64_t word) noexcept
+    {
+        m_low = mix(m_low ^ word);
+        m_high = mix(((m_high << 29) | (m_high >> 35)) + word * 0x9e3779b97f4a7c15ULL);
+        ++m_count;
+    }
+
+    void add(std::string_view bytes) noexcept
+    {
+        add(static_cast<std::uint64_t>(bytes.size()));
+        while (!bytes.empty())
+        {
+            std::uint64_t word = 0;
+            const std::size_t n = std::min(bytes.size(), sizeof(word));
+            std::memcpy(&word, bytes.data(), n);
+            add(word);
+            bytes.remove_prefix(n);
+        }
+    }
+
+    void add(const hash128_t& hash) noexcept
+    {
+        add(hash.m_low);
+        add(hash.m_high);
+    }
+
+    hash128_t finish() const noexcept { return hash128_t{ mix(m_low ^ m_count), mix(m_high + m_count) }; }
+
+private:
+    std::uint64_t m_low = 0x243f6a8885a308d3ULL;
+    std::uint64_t m_high = 0x13198a2e03707344ULL;
+    std::uint64_t m_count = 0;
+
+    static std::uint64_t mix(std::uint64_t x) noexcept
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+};
+
+// Computes the hash of a value from the hashes of its elements, reusing and filling the caches of collections.
+// `m_exact` is cleared when the hash involves floating point values or callables.
+struct hash_visitor
+{
+    std::size_t m_type;
+    bool& m_exact;
+
+    static hash128_t of(const value_t& value, bool& exact)
+    {
+        return std::visit(hash_visitor{ value.m_data.index(), exact }, value.m_data);
+    }
+
+    template <class T>
+    hash128_t operator()(const box_t<T>& box) const
+    {
+        if (const auto cached = box.m_hash.load())
+        {
+            m_exact = m_exact && cached->second;
+            return cached->first;
+        }
+        bool exact = true;
+        const hash128_t hash = hash_visitor{ m_type, exact }(box.get());
+        box.m_hash.store(hash, exact);
+        m_exact = m_exact && exact;
+        return hash;
+    }
+
+    hash128_t operator()(nil_t) const { return start().finish(); }
+
+    hash128_t operator()(integer_t v) const { return word(static_cast<std::uint64_t>(static_cast<std::int64_t>(v))); }
+
+    hash128_t operator()(floating_point_t v) const
+    {
+        m_exact = false;
+        if (v == 0.0)
+        {
+            v = 0.0;  // -0.0 == 0.0
+        }
+        else if (std::isnan(v))
+        {
+            v = std::numeric_limits<floating_point_t>::quiet_NaN();
+        }
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return word(bits);
+    }
+
+    hash128_t operator()(boolean_t v) const { return word(v ? 1 : 0); }
+
+    hash128_t operator()(character_t v) const { return word(static_cast<unsigned char>(v)); }
+
+    hash128_t operator()(const std::string& v) const
+    {
+        hasher_t hasher = start();
+        hasher.add(std::string_view{ v });
+        return hasher.finish();
+    }
+
+    hash128_t operator()(const tagged_element_t& v) const
+    {
+        hasher_t hasher = start();
+        hasher.add(std::string_view{ v.tag() });
+        hasher.add(hash_visitor{ 0, m_exact }(v.m_element));
+        return hasher.finish();
+    }
+
+    hash128_t operator()(const quoted_element_t& v) const
+    {
+        hasher_t hasher = start();
+        hasher.add(hash_visitor{ 0, m_exact }(v.m_element));
+        return hasher.finish();
+    }
+
+    // The element of a tagged or quoted element.
+    hash128_t operator()(const value_t& v) const { return of(v, m_exact); }
+
+    hash128_t operator()(const callable_t& v) const
+    {
+        m_exact = false;
+        return word(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(&v)));
+    }
+
+    hash128_t operator()(const atom_t& v) const
+    {
+        return word(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(v.m_state.get())));
+    }
+
+    hash128_t operator()(const future_t& v) const
+    {
+        return word(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(v.m_state.get())));
+    }
+
+    hash128_t operator()(const vector_t& v) const { return sequence(v); }
+    hash128_t operator()(const list_t& v) const { return sequence(v); }
+    hash128_t operator()(const set_t& v) const { return sequence(v); }
+    hash128_t operator()(const sorted_set_t& v) const { return sequence(v); }
+    hash128_t operator()(const map_t& v) const { return sequence(v); }
+    hash128_t operator()(const sorted_map_t& v) const { return sequence(v); }
+
+private:
+    hasher_t start() const
+    {
+        hasher_t hasher = {};
+        hasher.add(static_cast<std::uint64_t>(m_type));
+        return hasher;
+    }
+
+    hash128_t word(std::uint64_t v) const
+    {
+        hasher_t hasher = start();
+        hasher.add(v);
+        return hasher.finish();
+    }
+
+    void add(hasher_t& hasher, const value_t& item) const { hasher.add(of(item, m_exact)); }
+
+    void add(hasher_t& hasher, const std::pair<value_t, value_t>& entry) const
+    {
+        add(hasher, entry.first);
+        add(hasher, entry.second);
+    }
+
+    template <class Range>
+    hash128_t sequence(const Range& range) const
+    {
+        hasher_t hasher = start();
+        hasher.add(static_cast<std::uint64_t>(range.size()));
+        for (const auto& item : range)
+        {
+            add(hasher, item);
+        }
+        return hasher.finish();
+    }
+};
+
+inline void write_canonical_float(std::ostream& os, floating_point_t v)
+{
+    if (std::isnan(v))
+    {
+        os << "##NaN";
+        return;
+    }
+    if (std::isinf(v))
+    {
+        os << (v > 0 ? "##Inf" : "##-Inf");
+        return;
+    }
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), v == 0.0 ? 0.0 : v);
+    (void)ec;
+    const std::string_view text{ buffer, static_cast<std::size_t>(end - buffer) };
+    os << text;
+    if (text.find_first_of(".e") == std::string_view::npos)
+    {
+        os << ".0";
+    }
+}
+
+inline void write_canonical_string(std::ostream& os, const string_t& v)
+{
+    os << '"';
+    for (const char ch : v)
+    {
+        switch (ch)
+        {
+            case '"': os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default: os << ch; break;
+        }
+    }
+    os << '"';
+}
+
+struct canonical_visitor
+{
+    std::ostream& os;
+
+    void operator()(nil_t) const { os << "nil"; }
+    void operator()(integer_t v) const { os << v; }
+    void operator()(floating_point_t v) const { write_canonical_float(os, v); }
+    void operator()(boolean_t v) const { os << (v ? "true" : "false"); }
+    void operator()(character_t v) const { format_character(os, v); }
+    void operator()(const string_t& v) const { write_canonical_string(os, v); }
+    void operator()(const symbol_t& v) const { os << v; }
+    void operator()(const keyword_t& v) const { os << v; }
+    void operator()(const vector_t& v) const { sequence("[", v, "]"); }
+    void operator()(const list_t& v) const { sequence("(", v, ")"); }
+    void operator()(const set_t& v) const { sequence("#{", sorted(v), "}"); }
+    void operator()(const sorted_set_t& v) const { sequence("#{", v, "}"); }
+    void operator()(const map_t& v) const { entries(sorted(v)); }
+    void operator()(const sorted_map_t& v) const { entries(v); }
+
+    void operator()(const tagged_element_t& v) const
+    {
+        os << "#" << v.tag() << " ";
+        write(v.element());
+    }
+
+    void operator()(const quoted_element_t& v) const
+    {
+        os << "'";
+        write(v.element());
+    }
+
+    void operator()(const callable_t&) const { unsupported(value_type_t::callable); }
+    void operator()(const atom_t&) const { unsupported(value_type_t::atom); }
+    void operator()(const future_t&) const { unsupported(value_type_t::future); }
+
+    void write(const value_t& value) const { std::visit(unboxing_visitor{ *this }, value.m_data); }
+
+private:
+    [[noreturn]] static void unsupported(value_type_t type)
+    {
+        throw std::runtime_error{ str("no canonical form for ", type) };
+    }
+
+    static const value_t& key_of(const value_t& item) { return item; }
+    static const value_t& key_of(const std::pair<value_t, value_t>& entry) { return entry.first; }
+
+    // Pointers to the items in edn::compare order.
+    template <class Range>
+    static std::vector<const typename Range::value_type*> sorted(const Range& range)
+    {
+        std::vector<const typename Range::value_type*> result;
+        result.reserve(range.size());
+        for (const auto& item : range)
+        {
+            result.push_back(&item);
+        }
+        std::sort(
+            result.begin(),
+            result.end(),
+            [](const auto* lhs, const auto* rhs) { return compare(key_of(*lhs), key_of(*rhs)) < 0; });
+        return result;
+    }
+
+    static const value_t& deref(const value_t& item) { return item; }
+    static const value_t& deref(const value_t* item) { return *item; }
+    static const std::pair<value_t, value_t>& deref(const std::pair<value_t, value_t>& entry) { return entry; }
+    static const std::pair<value_t, value_t>& deref(const std::pair<value_t, value_t>* entry) { return *entry; }
+
+    template <class Range>
+    void sequence(const char* open, const Range& range, const char* close) const
+    {
+        os << open;
+        bool first = true;
+        for (const auto& item : range)
+        {
+            os << (first ? "" : " ");
+            first = false;
+            write(deref(item));
+        }
+        os << close;
+    }
+
+    template <class Range>
+    void entries(const Range& range) const
+    {
+        os << "{";
+        bool first = true;
+        for (const auto& item : range)
+        {
+            const auto& [key, value] = deref(item);
+            os << (first ? "" : " ");
+            first = false;
+            write(key);
+            os << " ";
+            write(value);
+        }
+        os << "}";
+    }
+};
+
+}  // namespace detail
+
+// Merkle-style hash of the content of `value`: collections hash their type, size and the hashes of their elements in
+// iteration order, so equal values (by operator==, with floating point values compared exactly) have equal hashes.
+// The hash of every collection is cached in the collection and reused until it is modified, which makes repeated
+// hashing of a mostly unchanged tree proportional to the changed part, and lets operator== reject collections with
+// different cached hashes in O(1). Atoms and futures hash by identity.
+inline hash128_t content_hash(const value_t& value)
+{
+    bool exact = true;
+    return detail::hash_visitor::of(value, exact);
+}
+
+// Writes `value` in a normalized form: single spaces between elements, set elements and map entries in edn::compare
+// order, floating point values in their shortest round-trip form (always with a fraction or exponent), strings with
+// escape sequences. Equal values print identically; atoms, futures and callables have no canonical form.
+inline void write_canonical(std::ostream& os, const value_t& value)
+{
+    detail::canonical_visitor{ os }.write(value);
+}
+
+inline std::string to_canonical_string(const value_t& value)
+{
+    std::ostringstream ss;
+    write_canonical(ss, value);
+    return ss.str();
+}
+
+}  // namespace edn
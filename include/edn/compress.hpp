@@ -0,0 +1,638 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <edn/spsc_queue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Compression needs the libraries linked in, so it is enabled by the build (see edn_enable_compression in
+// CMakeLists.txt) rather than detected here.
+#ifndef EDN_HAS_ZLIB
+#define EDN_HAS_ZLIB 0
+#endif
+
+#ifndef EDN_HAS_ZSTD
+#define EDN_HAS_ZSTD 0
+#endif
+
+#if EDN_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#if EDN_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace edn
+{
+
+enum class compression_t
+{
+    none,
+    gzip,
+    zlib,
+    zstd
+};
+
+inline std::ostream& operator<<(std::ostream& os, const compression_t item)
+{
+    switch (item)
+    {
+        case compression_t::none: return os << "none";
+        case compression_t::gzip: return os << "gzip";
+        case compression_t::zlib: return os << "zlib";
+        case compression_t::zstd: return os << "zstd";
+    }
+    return os;
+}
+
+// Format of data starting with `prefix`, from its magic number; none if it does not look compressed.
+inline compression_t detect_compression(std::string_view prefix)
+{
+    const auto byte = [&](std::size_t i) { return static_cast<unsigned char>(prefix[i]); };
+    if (prefix.size() >= 2 && byte(0) == 0x1f && byte(1) == 0x8b)
+    {
+        return compression_t::gzip;
+    }
+    if (prefix.size() >= 4 && byte(0) == 0x28 && byte(1) == 0xb5 && byte(2) == 0x2f && byte(3) == 0xfd)
+    {
+        return compression_t::zstd;
+    }
+    // Only the zlib headers written at the usual window size are recognized; the general rule (deflate method and a
+    // check value) would match plain text starting with, say, "hi" too often.
+    if (prefix.size() >= 2 && byte(0) == 0x78 && (byte(1) == 0x01 || byte(1) == 0x5e || byte(1) == 0x9c || byte(1) == 0xda))
+    {
+        return compression_t::zlib;
+    }
+    return compression_t::none;
+}
+
+inline bool compression_available(compression_t format)
+{
+    switch (format)
+    {
+        case compression_t::none: return true;
+        case compression_t::gzip:
+        case compression_t::zlib: return EDN_HAS_ZLIB;
+        case compression_t::zstd: return EDN_HAS_ZSTD;
+    }
+    return false;
+}
+
+namespace detail
+{
+
+// Decoders turn compressed input into output; decode() consumes from the front of `input` and returns the number of
+// bytes written to `out`, which is less than `size` only once all of the input has been consumed.
+
+struct copy_decoder_t
+{
+    std::size_t decode(std::string_view& input, char* out, std::size_t size)
+    {
+        const std::size_t count = std::min(size, input.size());
+        std::copy_n(input.data(), count, out);
+        input.remove_prefix(count);
+        return count;
+    }
+
+    bool complete() const { return true; }
+};
+
+#if EDN_HAS_ZLIB
+
+// Reads gzip or zlib data (told apart by their headers), including gzip files of several concatenated members.
+class zlib_decoder_t
+{
+public:
+    zlib_decoder_t()
+    {
+        if (inflateInit2(&m_stream, 15 + 32) != Z_OK)
+        {
+            throw std::runtime_error{ "compress: cannot initialize zlib" };
+        }
+    }
+
+    zlib_decoder_t(const zlib_decoder_t&) = delete;
+    zlib_decoder_t& operator=(const zlib_decoder_t&) = delete;
+
+    ~zlib_decoder_t() { inflateEnd(&m_stream); }
+
+    std::size_t decode(std::string_view& input, char* out, std::size_t size)
+    {
+        std::size_t produced = 0;
+        while (produced < size && (!input.empty() || !m_ended))
+        {
+            if (m_ended)
+            {
+                inflateReset(&m_stream);
+                m_ended = false;
+            }
+            m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+            m_stream.avail_in = static_cast<uInt>(std::min<std::size_t>(input.size(), max_chunk));
+            m_stream.next_out = reinterpret_cast<Bytef*>(out + produced);
+            m_stream.avail_out = static_cast<uInt>(std::min<std::size_t>(size - produced, max_chunk));
+            const uInt available_in = m_stream.avail_in;
+            const uInt available_out = m_stream.avail_out;
+            const int result = inflate(&m_stream, Z_NO_FLUSH);
+            input.remove_prefix(available_in - m_stream.avail_in);
+            produced += available_out - m_stream.avail_out;
+            if (result == Z_STREAM_END)
+            {
+                m_ended = true;
+            }
+            else if (result == Z_BUF_ERROR || (result == Z_OK && available_in == m_stream.avail_in
+                                                && available_out == m_stream.avail_out))
+            {
+                break;  // needs more input
+            }
+            else if (result != Z_OK)
+            {
+                throw std::runtime_error{ str("compress: corrupt zlib data: ", m_stream.msg ? m_stream.msg : "") };
+            }
+        }
+        return produced;
+    }
+
+    bool complete() const { return m_ended; }
+
+private:
+    static constexpr std::size_t max_chunk = 1 << 30;  // avail_in and avail_out are 32 bits wide
+    z_stream m_stream = {};
+    bool m_ended = false;
+};
+
+#endif
+
+#if EDN_HAS_ZSTD
+
+class zstd_decoder_t
+{
+public:
+    zstd_decoder_t() : m_stream(ZSTD_createDStream())
+    {
+        if (!m_stream)
+        {
+            throw std::runtime_error{ "compress: cannot initialize zstd" };
+        }
+    }
+
+    zstd_decoder_t(const zstd_decoder_t&) = delete;
+    zstd_decoder_t& operator=(const zstd_decoder_t&) = delete;
+
+    ~zstd_decoder_t() { ZSTD_freeDStream(m_stream); }
+
+    std::size_t decode(std::string_view& input, char* out, std::size_t size)
+    {
+        ZSTD_outBuffer output = { out, size, 0 };
+        while (output.pos < output.size)
+        {
+            ZSTD_inBuffer in = { input.data(), input.size(), 0 };
+            const std::size_t before = output.pos;
+            const std::size_t result = ZSTD_decompressStream(m_stream, &output, &in);
+            if (ZSTD_isError(result))
+            {
+                throw std::runtime_error{ str("compress: corrupt zstd data: ", ZSTD_getErrorName(result)) };
+            }
+            input.remove_prefix(in.pos);
+            if (in.pos == 0 && output.pos == before)
+            {
+                break;  // needs more input
+            }
+            m_complete = result == 0;  // at the end of a frame with everything flushed
+        }
+        return output.pos;
+    }
+
+    bool complete() const { return m_complete; }
+
+private:
+    ZSTD_DStream* m_stream;
+    bool m_complete = true;
+};
+
+#endif
+
+// Stream buffer fed by a thread that reads the source and decompresses it, handing chunks over through a bounded
+// queue, so that decompression overlaps with whatever consumes the data.
+class decompressing_streambuf : public std::streambuf
+{
+public:
+    decompressing_streambuf(std::istream& source, std::size_t chunk_size, std::size_t queue_chunks)
+        : m_source(source)
+        , m_chunk_size(std::max<std::size_t>(chunk_size, 1))
+        , m_queue(std::max<std::size_t>(queue_chunks, 2))
+    {
+        std::string first = read_chunk();
+        m_format = detect_compression(first);
+        if (!compression_available(m_format))
+        {
+            throw std::runtime_error{ str("compress: ", m_format, " support is not enabled") };
+        }
+        m_thread = std::thread{ [this, first = std::move(first)]() mutable { run(std::move(first)); } };
+    }
+
+    decompressing_streambuf(const decompressing_streambuf&) = delete;
+    decompressing_streambuf& operator=(const decompressing_streambuf&) = delete;
+
+    ~decompressing_streambuf() override
+    {
+        m_stop = true;
+        m_thread.join();
+    }
+
+    compression_t format() const { return m_format; }
+
+protected:
+    int_type underflow() override
+    {
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+        while (!m_done)
+        {
+            std::optional<std::string> chunk = m_queue.pop();
+            if (!chunk)
+            {
+                m_done = true;
+                if (m_error)
+                {
+                    std::rethrow_exception(m_error);
+                }
+                break;
+            }
+            if (!chunk->empty())
+            {
+                m_current = std::move(*chunk);
+                setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+                return traits_type::to_int_type(*gptr());
+            }
+        }
+        return traits_type::eof();
+    }
+
+private:
+    std::istream& m_source;
+    const std::size_t m_chunk_size;
+    compression_t m_format = compression_t::none;
+    spsc_queue_t<std::optional<std::string>> m_queue;
+    std::exception_ptr m_error;  // written before the end marker is pushed
+    std::atomic<bool> m_stop = false;
+    std::thread m_thread;
+    std::string m_current;
+    bool m_done = false;
+
+    std::string read_chunk()
+    {
+        std::string result(m_chunk_size, '\0');
+        m_source.read(result.data(), static_cast<std::streamsize>(result.size()));
+        result.resize(static_cast<std::size_t>(m_source.gcount()));
+        return result;
+    }
+
+    template <class Decoder>
+    void pump(Decoder& decoder, std::string input)
+    {
+        std::string_view pending = input;
+        bool eof = input.size() < m_chunk_size;
+        while (!m_stop)
+        {
+            std::string out(m_chunk_size, '\0');
+            const std::size_t before = pending.size();
+            out.resize(decoder.decode(pending, out.data(), out.size()));
+            const bool progress = !out.empty() || pending.size() != before;
+            if (!out.empty() && !m_queue.push(std::move(out), m_stop))
+            {
+                return;
+            }
+            if (progress)
+            {
+                continue;  // the decoder may hold more output even when the input is used up
+            }
+            if (!pending.empty())
+            {
+                throw std::runtime_error{ "compress: decoder made no progress" };
+            }
+            if (eof)
+            {
+                if (!decoder.complete())
+                {
+                    throw std::runtime_error{ str("compress: truncated ", m_format, " stream") };
+                }
+                return;
+            }
+            input = read_chunk();
+            pending = input;
+            eof = input.size() < m_chunk_size;
+        }
+    }
+
+    void run(std::string first)
+    {
+        try
+        {
+            switch (m_format)
+            {
+                case compression_t::none:
+                {
+                    copy_decoder_t decoder;
+                    pump(decoder, std::move(first));
+                    break;
+                }
+#if EDN_HAS_ZLIB
+                case compression_t::gzip:
+                case compression_t::zlib:
+                {
+                    zlib_decoder_t decoder;
+                    pump(decoder, std::move(first));
+                    break;
+                }
+#endif
+#if EDN_HAS_ZSTD
+                case compression_t::zstd:
+                {
+                    zstd_decoder_t decoder;
+                    pump(decoder, std::move(first));
+                    break;
+                }
+#endif
+                default: break;
+            }
+        }
+        catch (...)
+        {
+            m_error = std::current_exception();
+        }
+        m_queue.push(std::nullopt, m_stop);
+    }
+};
+
+#if EDN_HAS_ZLIB
+
+class zlib_encoder_t
+{
+public:
+    zlib_encoder_t(compression_t format, int level)
+    {
+        const int window_bits = format == compression_t::gzip ? 15 + 16 : 15;
+        const int compression_level = level < 0 ? Z_DEFAULT_COMPRESSION : level;
+        if (deflateInit2(&m_stream, compression_level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw std::runtime_error{ "compress: cannot initialize zlib" };
+        }
+    }
+
+    zlib_encoder_t(const zlib_encoder_t&) = delete;
+    zlib_encoder_t& operator=(const zlib_encoder_t&) = delete;
+
+    ~zlib_encoder_t() { deflateEnd(&m_stream); }
+
+    // Compresses `input`, flushing (flush) or ending (finish) the stream, and passes the output to `sink`.
+    template <class Sink>
+    void encode(std::string_view input, bool flush, bool finish, Sink&& sink)
+    {
+        char buffer[64 * 1024];
+        m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        m_stream.avail_in = static_cast<uInt>(input.size());
+        const int mode = finish ? Z_FINISH : flush ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+        while (true)
+        {
+            m_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            m_stream.avail_out = sizeof(buffer);
+            const int result = deflate(&m_stream, mode);
+            if (result == Z_STREAM_ERROR)
+            {
+                throw std::runtime_error{ "compress: zlib error" };
+            }
+            sink(std::string_view{ buffer, sizeof(buffer) - m_stream.avail_out });
+            if (finish ? result == Z_STREAM_END : m_stream.avail_out != 0)
+            {
+                return;
+            }
+        }
+    }
+
+private:
+    z_stream m_stream = {};
+};
+
+#endif
+
+#if EDN_HAS_ZSTD
+
+class zstd_encoder_t
+{
+public:
+    explicit zstd_encoder_t(int level) : m_stream(ZSTD_createCCtx())
+    {
+        if (!m_stream)
+        {
+            throw std::runtime_error{ "compress: cannot initialize zstd" };
+        }
+        ZSTD_CCtx_setParameter(m_stream, ZSTD_c_compressionLevel, level < 0 ? ZSTD_CLEVEL_DEFAULT : level);
+    }
+
+    zstd_encoder_t(const zstd_encoder_t&) = delete;
+    zstd_encoder_t& operator=(const zstd_encoder_t&) = delete;
+
+    ~zstd_encoder_t() { ZSTD_freeCCtx(m_stream); }
+
+    template <class Sink>
+    void encode(std::string_view input, bool flush, bool finish, Sink&& sink)
+    {
+        char buffer[64 * 1024];
+        ZSTD_inBuffer in = { input.data(), input.size(), 0 };
+        const ZSTD_EndDirective mode = finish ? ZSTD_e_end : flush ? ZSTD_e_flush : ZSTD_e_continue;
+        while (true)
+        {
+            ZSTD_outBuffer out = { buffer, sizeof(buffer), 0 };
+            const std::size_t remaining = ZSTD_compressStream2(m_stream, &out, &in, mode);
+            if (ZSTD_isError(remaining))
+            {
+                throw std::runtime_error{ str("compress: zstd error: ", ZSTD_getErrorName(remaining)) };
+            }
+            sink(std::string_view{ buffer, out.pos });
+            if (mode == ZSTD_e_continue ? in.pos == in.size : remaining == 0)
+            {
+                return;
+            }
+        }
+    }
+
+private:
+    ZSTD_CCtx* m_stream;
+};
+
+#endif
+
+// Stream buffer that compresses what is written to it into `sink` on the writing thread.
+class compressing_streambuf : public std::streambuf
+{
+public:
+    compressing_streambuf(std::ostream& sink, compression_t format, [[maybe_unused]] int level, std::size_t buffer_size)
+        : m_sink(sink)
+        , m_format(format)
+        , m_buffer(std::max<std::size_t>(buffer_size, 1), '\0')
+    {
+        if (!compression_available(format))
+        {
+            throw std::runtime_error{ str("compress: ", format, " support is not enabled") };
+        }
+        switch (format)
+        {
+#if EDN_HAS_ZLIB
+            case compression_t::gzip:
+            case compression_t::zlib: m_zlib.emplace(format, level); break;
+#endif
+#if EDN_HAS_ZSTD
+            case compression_t::zstd: m_zstd.emplace(level); break;
+#endif
+            default: break;
+        }
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+    compressing_streambuf(const compressing_streambuf&) = delete;
+    compressing_streambuf& operator=(const compressing_streambuf&) = delete;
+
+    // Compresses what is buffered and ends the stream; nothing may be written afterwards.
+    void finish()
+    {
+        if (!m_finished)
+        {
+            m_finished = true;
+            encode(false, true);
+            m_sink.flush();
+        }
+    }
+
+    bool finished() const { return m_finished; }
+
+protected:
+    int_type overflow(int_type c) override
+    {
+        if (m_finished)
+        {
+            return traits_type::eof();
+        }
+        encode(false, false);
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    // Flushes the compressor, so that everything written so far can be decompressed from the sink.
+    int sync() override
+    {
+        if (!m_finished)
+        {
+            encode(true, false);
+            m_sink.flush();
+        }
+        return m_sink ? 0 : -1;
+    }
+
+private:
+    std::ostream& m_sink;
+    compression_t m_format;
+    std::string m_buffer;
+    bool m_finished = false;
+#if EDN_HAS_ZLIB
+    std::optional<zlib_encoder_t> m_zlib;
+#endif
+#if EDN_HAS_ZSTD
+    std::optional<zstd_encoder_t> m_zstd;
+#endif
+
+    void encode([[maybe_unused]] bool flush, [[maybe_unused]] bool finish)
+    {
+        const std::string_view input{ pbase(), static_cast<std::size_t>(pptr() - pbase()) };
+        const auto sink = [this](std::string_view output)
+        {
+            if (!m_sink.write(output.data(), static_cast<std::streamsize>(output.size())))
+            {
+                throw std::runtime_error{ "compress: cannot write the compressed stream" };
+            }
+        };
+        switch (m_format)
+        {
+#if EDN_HAS_ZLIB
+            case compression_t::gzip:
+            case compression_t::zlib: m_zlib->encode(input, flush, finish, sink); break;
+#endif
+#if EDN_HAS_ZSTD
+            case compression_t::zstd: m_zstd->encode(input, flush, finish, sink); break;
+#endif
+            default: sink(input); break;
+        }
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+};
+
+}  // namespace detail
+
+// Input stream over compressed data, with the format detected from the data itself (plain data passes through).
+// Decompression runs on a thread of its own, at most `queue_chunks` chunks ahead of the reader; the source must not
+// be used by anything else while this stream lives. Errors in the data are thrown from the reading call.
+class decompressing_istream : public std::istream
+{
+public:
+    explicit decompressing_istream(std::istream& source, std::size_t chunk_size = 64 * 1024, std::size_t queue_chunks = 8)
+        : std::istream(nullptr)
+        , m_buffer(source, chunk_size, queue_chunks)
+    {
+        rdbuf(&m_buffer);
+        exceptions(std::ios::badbit);
+    }
+
+    compression_t format() const { return m_buffer.format(); }
+
+private:
+    detail::decompressing_streambuf m_buffer;
+};
+
+// Output stream compressing into `sink`. A negative level selects the library's default. The stream is ended by
+// finish() or the destructor; flushing it makes everything written so far decompressible, at some cost in ratio.
+class compressing_ostream : public std::ostream
+{
+public:
+    explicit compressing_ostream(
+        std::ostream& sink, compression_t format = compression_t::gzip, int level = -1, std::size_t buffer_size = 64 * 1024)
+        : std::ostream(nullptr)
+        , m_buffer(sink, format, level, buffer_size)
+    {
+        rdbuf(&m_buffer);
+        exceptions(std::ios::badbit);
+    }
+
+    ~compressing_ostream() override
+    {
+        try
+        {
+            m_buffer.finish();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void finish() { m_buffer.finish(); }
+
+private:
+    detail::compressing_streambuf m_buffer;
+};
+
+}  // namespace edn
@@ -0,0 +1,407 @@
+#pragma once
+
+#include <edn/canonical.hpp>
+#include <edn/edn.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace edn
+{
+
+enum class edit_kind_t
+{
+    add,
+    remove,
+    replace
+};
+
+inline std::ostream& operator<<(std::ostream& os, const edit_kind_t item)
+{
+    switch (item)
+    {
+        case edit_kind_t::add: return os << "add";
+        case edit_kind_t::remove: return os << "remove";
+        case edit_kind_t::replace: return os << "replace";
+    }
+    return os;
+}
+
+// One step of an edit script. The path leads from the root to the edited node: indices for vectors and lists, keys
+// for maps and the elements themselves for sets. Added entries of vectors and lists are inserted at the given index.
+struct edit_t
+{
+    edit_kind_t m_kind;
+    vector_t m_path;
+    value_t m_value;
+
+    friend bool operator==(const edit_t& lhs, const edit_t& rhs)
+    {
+        return lhs.m_kind == rhs.m_kind && lhs.m_path == rhs.m_path && lhs.m_value == rhs.m_value;
+    }
+
+    friend bool operator!=(const edit_t& lhs, const edit_t& rhs) { return !(lhs == rhs); }
+
+    friend std::ostream& operator<<(std::ostream& os, const edit_t& item)
+    {
+        os << "[:" << item.m_kind << " " << item.m_path;
+        if (item.m_kind != edit_kind_t::remove)
+        {
+            os << " " << item.m_value;
+        }
+        return os << "]";
+    }
+};
+
+using edit_script_t = std::vector<edit_t>;
+
+namespace detail
+{
+
+class differ_t
+{
+public:
+    explicit differ_t(edit_script_t& edits) : m_edits(edits) { }
+
+    void run(const value_t& before, const value_t& after)
+    {
+        // Hashes are cached per collection, so after the first level this costs O(1) per subtree.
+        if (same(before, after))
+        {
+            return;
+        }
+        if (before.type() != after.type())
+        {
+            emit(edit_kind_t::replace, after);
+            return;
+        }
+        switch (before.type())
+        {
+            case value_type_t::vector: sequence(*before.if_vector(), *after.if_vector()); break;
+            case value_type_t::list: sequence(*before.if_list(), *after.if_list()); break;
+            case value_type_t::map: map(*before.if_map(), *after.if_map()); break;
+            case value_type_t::set: set(*before.if_set(), *after.if_set()); break;
+            case value_type_t::sorted_set: set(*before.if_sorted_set(), *after.if_sorted_set()); break;
+            case value_type_t::sorted_map: sorted_map(*before.if_sorted_map(), *after.if_sorted_map()); break;
+            default:
+                if (before != after)
+                {
+                    emit(edit_kind_t::replace, after);
+                }
+                break;
+        }
+    }
+
+private:
+    edit_script_t& m_edits;
+    vector_t m_path;
+
+    void emit(edit_kind_t kind, const value_t& value) { m_edits.push_back(edit_t{ kind, m_path, value }); }
+
+    void emit(edit_kind_t kind, const value_t& step, const value_t& value)
+    {
+        m_path.push_back(step);
+        emit(kind, value);
+        m_path.pop_back();
+    }
+
+    void child(const value_t& step, const value_t& before, const value_t& after)
+    {
+        m_path.push_back(step);
+        run(before, after);
+        m_path.pop_back();
+    }
+
+    static bool same(const value_t& lhs, const value_t& rhs) { return content_hash(lhs) == content_hash(rhs); }
+
+    static value_t index(std::size_t i) { return static_cast<integer_t>(i); }
+
+    // Common prefix and suffix are skipped; the remaining elements are compared pairwise and the excess is added or
+    // removed at the end of the changed range.
+    void sequence(const std::vector<value_t>& before, const std::vector<value_t>& after)
+    {
+        std::size_t prefix = 0;
+        while (prefix < before.size() && prefix < after.size() && same(before[prefix], after[prefix]))
+        {
+            ++prefix;
+        }
+        std::size_t suffix = 0;
+        while (suffix < before.size() - prefix && suffix < after.size() - prefix
+               && same(before[before.size() - 1 - suffix], after[after.size() - 1 - suffix]))
+        {
+            ++suffix;
+        }
+        const std::size_t before_count = before.size() - prefix - suffix;
+        const std::size_t after_count = after.size() - prefix - suffix;
+        const std::size_t common = std::min(before_count, after_count);
+        for (std::size_t i = prefix; i < prefix + common; ++i)
+        {
+            child(index(i), before[i], after[i]);
+        }
+        for (std::size_t i = prefix + common; i < prefix + after_count; ++i)
+        {
+            emit(edit_kind_t::add, index(i), after[i]);
+        }
+        for (std::size_t i = prefix + before_count; i > prefix + common; --i)
+        {
+            emit(edit_kind_t::remove, index(i - 1), value_t{});
+        }
+    }
+
+    // Patching appends new keys, so entry-wise edits reproduce `after` only when the keys kept from `before` come first
+    // and in the same order; otherwise the whole map is replaced.
+    static bool same_key_order(const map_t& before, const map_t& after)
+    {
+        std::size_t position = 0;
+        for (const auto& [key, value] : before)
+        {
+            if (after.find(key) == after.end())
+            {
+                continue;
+            }
+            if (position >= after.size() || after.m_items[position].first != key)
+            {
+                return false;
+            }
+            ++position;
+        }
+        return true;
+    }
+
+    void map(const map_t& before, const map_t& after)
+    {
+        if (!same_key_order(before, after))
+        {
+            emit(edit_kind_t::replace, value_t{ after });
+            return;
+        }
+        for (const auto& [key, value] : before)
+        {
+            if (after.find(key) == after.end())
+            {
+                emit(edit_kind_t::remove, key, value_t{});
+            }
+        }
+        for (const auto& [key, value] : after)
+        {
+            if (const auto it = before.find(key); it != before.end())
+            {
+                child(key, it->second, value);
+            }
+            else
+            {
+                emit(edit_kind_t::add, key, value);
+            }
+        }
+    }
+
+    template <class Set>
+    void set(const Set& before, const Set& after)
+    {
+        for (const value_t& item : before)
+        {
+            if (!contains(after, item))
+            {
+                emit(edit_kind_t::remove, item, value_t{});
+            }
+        }
+        for (const value_t& item : after)
+        {
+            if (!contains(before, item))
+            {
+                emit(edit_kind_t::add, item, item);
+            }
+        }
+    }
+
+    void sorted_map(const sorted_map_t& before, const sorted_map_t& after)
+    {
+        for (const auto& [key, value] : before)
+        {
+            if (!after.contains(key))
+            {
+                emit(edit_kind_t::remove, key, value_t{});
+            }
+        }
+        for (const auto& [key, value] : after)
+        {
+            if (const auto it = before.find(key); it != before.end())
+            {
+                child(key, it->second, value);
+            }
+            else
+            {
+                emit(edit_kind_t::add, key, value);
+            }
+        }
+    }
+
+    static bool contains(const set_t& set, const value_t& item) { return set.find(item) != set.end(); }
+    static bool contains(const sorted_set_t& set, const value_t& item) { return set.contains(item); }
+};
+
+inline std::size_t patch_index(const value_t& step, std::size_t size)
+{
+    const integer_t* maybe_index = step.if_integer();
+    if (!maybe_index)
+    {
+        throw std::runtime_error{ str("patch: expected index, got ", step) };
+    }
+    if (*maybe_index < 0 || static_cast<std::size_t>(*maybe_index) >= size)
+    {
+        throw std::out_of_range{ str("patch: index ", *maybe_index, " out of range for ", size, " elements") };
+    }
+    return static_cast<std::size_t>(*maybe_index);
+}
+
+inline value_t& patch_child(value_t& parent, const value_t& step)
+{
+    if (vector_t* maybe_vector = parent.if_mutable<vector_t>())
+    {
+        return (*maybe_vector)[patch_index(step, maybe_vector->size())];
+    }
+    if (list_t* maybe_list = parent.if_mutable<list_t>())
+    {
+        return (*maybe_list)[patch_index(step, maybe_list->size())];
+    }
+    if (map_t* maybe_map = parent.if_mutable<map_t>())
+    {
+        if (const auto it = maybe_map->find(step); it != maybe_map->end())
+        {
+            return it->second;
+        }
+    }
+    else if (sorted_map_t* maybe_sorted_map = parent.if_mutable<sorted_map_t>())
+    {
+        if (value_t* value = maybe_sorted_map->find_value(step))
+        {
+            return *value;
+        }
+    }
+    else
+    {
+        throw std::runtime_error{ str("patch: cannot descend into ", parent.type()) };
+    }
+    throw std::out_of_range{ str("patch: key not found: ", step) };
+}
+
+inline void patch_sequence(std::vector<value_t>& items, const edit_t& edit)
+{
+    const value_t& step = edit.m_path.back();
+    switch (edit.m_kind)
+    {
+        case edit_kind_t::add:
+        {
+            const std::size_t i = patch_index(step, items.size() + 1);
+            items.insert(items.begin() + static_cast<std::ptrdiff_t>(i), edit.m_value);
+            break;
+        }
+        case edit_kind_t::remove:
+            items.erase(items.begin() + static_cast<std::ptrdiff_t>(patch_index(step, items.size())));
+            break;
+        case edit_kind_t::replace: items[patch_index(step, items.size())] = edit.m_value; break;
+    }
+}
+
+inline void patch_map(map_t& map, const edit_t& edit)
+{
+    const value_t& key = edit.m_path.back();
+    if (edit.m_kind == edit_kind_t::remove)
+    {
+        const auto it = map.find(key);
+        if (it == map.end())
+        {
+            throw std::out_of_range{ str("patch: key not found: ", key) };
+        }
+        map.m_items.erase(it);
+    }
+    else
+    {
+        map[key] = edit.m_value;
+    }
+}
+
+template <class Set>
+void patch_set(Set& set, const edit_t& edit)
+{
+    if (edit.m_kind != edit_kind_t::add)
+    {
+        set.erase(edit.m_path.back());
+    }
+    if (edit.m_kind != edit_kind_t::remove)
+    {
+        set.insert(edit.m_value);
+    }
+}
+
+inline void patch_sorted_map(sorted_map_t& map, const edit_t& edit)
+{
+    if (edit.m_kind == edit_kind_t::remove)
+    {
+        map.erase(edit.m_path.back());
+    }
+    else
+    {
+        map.insert_or_assign(edit.m_path.back(), edit.m_value);
+    }
+}
+
+}  // namespace detail
+
+// Edit script turning `before` into `after`. Subtrees with equal content hashes are skipped without descending further;
+// nodes of different types (and maps whose key order changed) are replaced as a whole.
+inline edit_script_t diff(const value_t& before, const value_t& after)
+{
+    edit_script_t edits;
+    detail::differ_t{ edits }.run(before, after);
+    return edits;
+}
+
+// Applies `edits` in order, touching only the nodes along their paths.
+inline value_t patch(value_t value, const edit_script_t& edits)
+{
+    for (const edit_t& edit : edits)
+    {
+        if (edit.m_path.empty())
+        {
+            value = edit.m_kind == edit_kind_t::remove ? value_t{} : edit.m_value;
+            continue;
+        }
+        value_t* parent = &value;
+        for (auto it = edit.m_path.begin(); it != std::prev(edit.m_path.end()); ++it)
+        {
+            parent = &detail::patch_child(*parent, *it);
+        }
+        if (vector_t* maybe_vector = parent->if_mutable<vector_t>())
+        {
+            detail::patch_sequence(*maybe_vector, edit);
+        }
+        else if (list_t* maybe_list = parent->if_mutable<list_t>())
+        {
+            detail::patch_sequence(*maybe_list, edit);
+        }
+        else if (map_t* maybe_map = parent->if_mutable<map_t>())
+        {
+            detail::patch_map(*maybe_map, edit);
+        }
+        else if (set_t* maybe_set = parent->if_mutable<set_t>())
+        {
+            detail::patch_set(*maybe_set, edit);
+        }
+        else if (sorted_set_t* maybe_sorted_set = parent->if_mutable<sorted_set_t>())
+        {
+            detail::patch_set(*maybe_sorted_set, edit);
+        }
+        else if (sorted_map_t* maybe_sorted_map = parent->if_mutable<sorted_map_t>())
+        {
+            detail::patch_sorted_map(*maybe_sorted_map, edit);
+        }
+        else
+        {
+            throw std::runtime_error{ str("patch: cannot edit ", parent->type(), " at ", edit.m_path) };
+        }
+    }
+    return value;
+}
+
+}  // namespace edn
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <edn/btree.hpp>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <sstream>
@@ -110,28 +118,122 @@ struct ordered_map
     friend constexpr bool operator>=(const ordered_map& lhs, const ordered_map& rhs) { return !(lhs < rhs); }
 };
 
+struct hash128_t
+{
+    std::uint64_t m_low = 0;
+    std::uint64_t m_high = 0;
+
+    friend constexpr bool operator==(const hash128_t& lhs, const hash128_t& rhs)
+    {
+        return lhs.m_low == rhs.m_low && lhs.m_high == rhs.m_high;
+    }
+
+    friend constexpr bool operator!=(const hash128_t& lhs, const hash128_t& rhs) { return !(lhs == rhs); }
+
+    friend constexpr bool operator<(const hash128_t& lhs, const hash128_t& rhs)
+    {
+        return std::tie(lhs.m_high, lhs.m_low) < std::tie(rhs.m_high, rhs.m_low);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const hash128_t& item)
+    {
+        const auto flags = os.flags();
+        os << std::hex << std::setfill('0') << std::setw(16) << item.m_high << std::setw(16) << item.m_low;
+        os.flags(flags);
+        return os;
+    }
+};
+
+namespace detail
+{
+
+// Content hash of a boxed value, computed on demand (see content_hash) and dropped whenever the value is accessed for
+// writing. Readers racing to fill it store the same result, so they need no further synchronization.
+class hash_cache_t
+{
+public:
+    hash_cache_t() noexcept = default;
+
+    hash_cache_t(const hash_cache_t& other) noexcept { *this = other; }
+
+    hash_cache_t& operator=(const hash_cache_t& other) noexcept
+    {
+        if (const auto cached = other.load())
+        {
+            store(cached->first, cached->second);
+        }
+        else
+        {
+            reset();
+        }
+        return *this;
+    }
+
+    // The hash and whether equal hashes are equivalent to operator== (false when floating point values are involved,
+    // which operator== compares with a tolerance).
+    std::optional<std::pair<hash128_t, bool>> load() const noexcept
+    {
+        const std::uint8_t state = m_state.load(std::memory_order_acquire);
+        if (state == empty)
+        {
+            return std::nullopt;
+        }
+        return std::pair{ hash128_t{ m_low.load(std::memory_order_relaxed), m_high.load(std::memory_order_relaxed) },
+                          state == exact };
+    }
+
+    void store(const hash128_t& hash, bool is_exact) const noexcept
+    {
+        m_low.store(hash.m_low, std::memory_order_relaxed);
+        m_high.store(hash.m_high, std::memory_order_relaxed);
+        m_state.store(is_exact ? exact : inexact, std::memory_order_release);
+    }
+
+    void reset() noexcept { m_state.store(empty, std::memory_order_relaxed); }
+
+private:
+    static constexpr std::uint8_t empty = 0;
+    static constexpr std::uint8_t inexact = 1;
+    static constexpr std::uint8_t exact = 2;
+
+    mutable std::atomic<std::uint8_t> m_state = empty;
+    mutable std::atomic<std::uint64_t> m_low = 0;
+    mutable std::atomic<std::uint64_t> m_high = 0;
+};
+
+}  // namespace detail
+
 template <class T>
 struct box_t
 {
     using value_type = T;
     std::unique_ptr<value_type> m_ptr;
+    detail::hash_cache_t m_hash;
 
     box_t(const value_type& value) : m_ptr(std::make_unique<T>(value)) { }
 
     box_t(value_type&& value) : m_ptr(std::make_unique<T>(std::move(value))) { }
 
-    box_t(const box_t& other) : box_t(other.get()) { }
+    box_t(const box_t& other) : m_ptr(std::make_unique<T>(other.get())), m_hash(other.m_hash) { }
 
     box_t(box_t&&) noexcept = default;
 
     box_t& operator=(box_t other) noexcept
     {
         std::swap(m_ptr, other.m_ptr);
+        m_hash = other.m_hash;
         return *this;
     }
 
     constexpr const value_type& get() const& noexcept { return *m_ptr; }
 
+    // Write access; drops the cached hash.
+    value_type& get() & noexcept
+    {
+        m_hash.reset();
+        return *m_ptr;
+    }
+
     constexpr operator const value_type&() const noexcept { return get(); }
 
     friend std::ostream& operator<<(std::ostream& os, const box_t& item) { return os << item.get(); }
@@ -199,7 +301,11 @@ enum class value_type_t
     map,
     tagged_element,
     quoted_element,
-    callable
+    callable,
+    atom,
+    future,
+    sorted_set,
+    sorted_map
 };
 
 inline std::ostream& operator<<(std::ostream& os, const value_type_t item)
@@ -221,6 +327,10 @@ inline std::ostream& operator<<(std::ostream& os, const value_type_t item)
         case value_type_t::tagged_element: return os << "tagged_element";
         case value_type_t::quoted_element: return os << "quoted_element";
         case value_type_t::callable: return os << "callable";
+        case value_type_t::atom: return os << "atom";
+        case value_type_t::future: return os << "future";
+        case value_type_t::sorted_set: return os << "sorted_set";
+        case value_type_t::sorted_map: return os << "sorted_map";
     }
     return os;
 }
@@ -293,6 +403,65 @@ struct map_t : public ordered_map<value_t, value_t>
     friend std::ostream& operator<<(std::ostream& os, const map_t& item);
 };
 
+// Three-way comparison of values (negative, zero or positive), consistent with operator<.
+struct compare_fn
+{
+    int operator()(const value_t& lhs, const value_t& rhs) const;
+};
+
+static constexpr inline auto compare = compare_fn{};
+
+namespace detail
+{
+
+struct identity_key
+{
+    const value_t& operator()(const value_t& item) const { return item; }
+};
+
+struct first_key
+{
+    const value_t& operator()(const std::pair<value_t, value_t>& item) const;
+};
+
+}  // namespace detail
+
+// Set ordered by edn::compare, stored in a B-tree; supports range queries through subseq/rsubseq.
+struct sorted_set_t : public detail::btree<value_t, detail::identity_key, compare_fn>
+{
+    using base_t = detail::btree<value_t, detail::identity_key, compare_fn>;
+
+    sorted_set_t() = default;
+
+    sorted_set_t(std::initializer_list<value_t> items);
+
+    bool insert(value_t item);
+
+    friend std::ostream& operator<<(std::ostream& os, const sorted_set_t& item);
+};
+
+// Map ordered by edn::compare on keys, stored in a B-tree; supports range queries through subseq/rsubseq.
+struct sorted_map_t : public detail::btree<std::pair<value_t, value_t>, detail::first_key, compare_fn>
+{
+    using base_t = detail::btree<std::pair<value_t, value_t>, detail::first_key, compare_fn>;
+    using value_type = std::pair<value_t, value_t>;
+
+    sorted_map_t() = default;
+
+    sorted_map_t(std::initializer_list<value_type> items);
+
+    using base_t::insert_or_assign;
+
+    bool insert_or_assign(value_t key, value_t value);
+
+    const value_t& at(const value_t& key) const;
+
+    // Value stored under `key` for in-place updates, or null if there is none.
+    value_t* find_value(const value_t& key);
+
+    friend std::ostream& operator<<(std::ostream& os, const sorted_map_t& item);
+};
+
 struct tagged_element_t
 {
     symbol_t m_tag;
@@ -329,6 +498,69 @@ struct callable_t
     friend std::ostream& operator<<(std::ostream& os, const callable_t&) { return os << "<< callable >>"; }
 };
 
+// Shared, thread-safe reference to an immutable value. Copies of an atom_t refer to the same state; updates replace
+// the held value by compare-and-swap on the shared pointer, so concurrent writers never block each other.
+struct atom_t
+{
+    using pointer = std::shared_ptr<const value_t>;
+
+    struct state_t
+    {
+        pointer m_value;
+    };
+
+    std::shared_ptr<state_t> m_state;
+
+    explicit atom_t(const value_t& value);
+
+    pointer load() const { return std::atomic_load(&m_state->m_value); }
+
+    value_t deref() const;
+
+    value_t reset(const value_t& value) const;
+
+    bool compare_and_set(const pointer& expected, const value_t& value) const;
+
+    // Applies `func` to the current value and installs the result; retries with the fresh value on conflict,
+    // hence `func` may be called more than once and should be free of side effects.
+    template <class Func>
+    value_t swap(Func&& func) const;
+
+    friend bool operator==(const atom_t& lhs, const atom_t& rhs) { return lhs.m_state == rhs.m_state; }
+    friend bool operator<(const atom_t& lhs, const atom_t& rhs) { return std::less<>{}(lhs.m_state, rhs.m_state); }
+
+    friend std::ostream& operator<<(std::ostream& os, const atom_t&) { return os << "<< atom >>"; }
+};
+
+// Write-once slot shared between a producer and any number of readers. Serves both as a promise (delivered explicitly)
+// and as the handle of an asynchronous computation (delivered by the task that computes it).
+struct future_t
+{
+    struct state_t;
+
+    std::shared_ptr<state_t> m_state;
+
+    future_t();
+
+    bool deliver(const value_t& value) const;
+
+    bool fail(std::exception_ptr error) const;
+
+    bool is_ready() const;
+
+    template <class Rep, class Period>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const;
+
+    void wait() const;
+
+    value_t deref() const;
+
+    friend bool operator==(const future_t& lhs, const future_t& rhs) { return lhs.m_state == rhs.m_state; }
+    friend bool operator<(const future_t& lhs, const future_t& rhs) { return std::less<>{}(lhs.m_state, rhs.m_state); }
+
+    friend std::ostream& operator<<(std::ostream& os, const future_t&) { return os << "<< future >>"; }
+};
+
 struct value_t
 {
     using data_type = std::variant<
@@ -346,7 +578,11 @@ struct value_t
         box_t<map_t>,
         tagged_element_t,
         quoted_element_t,
-        box_t<callable_t>>;
+        box_t<callable_t>,
+        atom_t,
+        future_t,
+        box_t<sorted_set_t>,
+        box_t<sorted_map_t>>;
 
     data_type m_data;
 
@@ -367,6 +603,10 @@ struct value_t
     value_t(tagged_element_t v) : m_data(std::move(v)) { }
     value_t(quoted_element_t v) : m_data(std::move(v)) { }
     value_t(callable_t v) : m_data(std::move(v)) { }
+    value_t(atom_t v) : m_data(std::move(v)) { }
+    value_t(future_t v) : m_data(std::move(v)) { }
+    value_t(sorted_set_t v) : m_data(std::move(v)) { }
+    value_t(sorted_map_t v) : m_data(std::move(v)) { }
 
     value_t(const value_t&) = default;
     value_t(value_t&&) noexcept = default;
@@ -405,6 +645,10 @@ struct value_t
             constexpr auto operator()(const tagged_element_t&) const -> value_type_t { return value_type_t::tagged_element; }
             constexpr auto operator()(const quoted_element_t&) const -> value_type_t { return value_type_t::quoted_element; }
             constexpr auto operator()(const callable_t&) const -> value_type_t { return value_type_t::callable; }
+            constexpr auto operator()(const atom_t&) const -> value_type_t { return value_type_t::atom; }
+            constexpr auto operator()(const future_t&) const -> value_type_t { return value_type_t::future; }
+            constexpr auto operator()(const sorted_set_t&) const -> value_type_t { return value_type_t::sorted_set; }
+            constexpr auto operator()(const sorted_map_t&) const -> value_type_t { return value_type_t::sorted_map; }
         };
         return std::visit(unboxing_visitor{ visitor{} }, m_data);
     }
@@ -460,6 +704,48 @@ struct value_t
         }
         return nullptr;
     }
+    constexpr const atom_t* if_atom() const { return std::get_if<atom_t>(&m_data); }
+    constexpr const future_t* if_future() const { return std::get_if<future_t>(&m_data); }
+    constexpr const sorted_set_t* if_sorted_set() const
+    {
+        if (auto ptr = std::get_if<box_t<sorted_set_t>>(&m_data))
+        {
+            return &ptr->get();
+        }
+        return nullptr;
+    }
+    constexpr const sorted_map_t* if_sorted_map() const
+    {
+        if (auto ptr = std::get_if<box_t<sorted_map_t>>(&m_data))
+        {
+            return &ptr->get();
+        }
+        return nullptr;
+    }
+
+    // Mutable access to the stored alternative, for in-place editors such as zipper_t.
+    template <class T>
+    constexpr T* if_mutable()
+    {
+        if constexpr (is_boxed<T>)
+        {
+            if (auto ptr = std::get_if<box_t<T>>(&m_data))
+            {
+                return &ptr->get();
+            }
+            return nullptr;
+        }
+        else
+        {
+            return std::get_if<T>(&m_data);
+        }
+    }
+
+private:
+    template <class T>
+    static constexpr bool is_boxed = std::is_same_v<T, vector_t> || std::is_same_v<T, list_t> || std::is_same_v<T, set_t>
+                                     || std::is_same_v<T, map_t> || std::is_same_v<T, callable_t>
+                                     || std::is_same_v<T, sorted_set_t> || std::is_same_v<T, sorted_map_t>;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const nil_t&)
@@ -527,6 +813,36 @@ inline std::ostream& operator<<(std::ostream& os, const map_t& item)
     return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os, const sorted_set_t& item)
+{
+    os << "#{";
+    for (auto it = item.begin(); it != item.end(); ++it)
+    {
+        if (it != item.begin())
+        {
+            os << " ";
+        }
+        os << *it;
+    }
+    os << "}";
+    return os;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const sorted_map_t& item)
+{
+    os << "{";
+    for (auto it = item.begin(); it != item.end(); ++it)
+    {
+        if (it != item.begin())
+        {
+            os << " ";
+        }
+        os << it->first << " " << it->second;
+    }
+    os << "}";
+    return os;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const tagged_element_t& item)
 {
     return os << "#" << item.tag() << " " << item.element();
@@ -542,6 +858,161 @@ inline value_t callable_t::operator()(const std::vector<value_t>& args) const
     return m_function(args);
 }
 
+inline const value_t& detail::first_key::operator()(const std::pair<value_t, value_t>& item) const
+{
+    return item.first;
+}
+
+inline bool sorted_set_t::insert(value_t item)
+{
+    return insert_or_assign(std::move(item));
+}
+
+inline sorted_set_t::sorted_set_t(std::initializer_list<value_t> items)
+{
+    for (const value_t& item : items)
+    {
+        insert(item);
+    }
+}
+
+inline sorted_map_t::sorted_map_t(std::initializer_list<value_type> items)
+{
+    for (const value_type& item : items)
+    {
+        insert_or_assign(item);
+    }
+}
+
+inline bool sorted_map_t::insert_or_assign(value_t key, value_t value)
+{
+    return insert_or_assign(value_type{ std::move(key), std::move(value) });
+}
+
+inline const value_t& sorted_map_t::at(const value_t& key) const
+{
+    const auto it = find(key);
+    if (it == end())
+    {
+        throw std::out_of_range{ str("key not found in sorted_map_t: ", key) };
+    }
+    return it->second;
+}
+
+inline value_t* sorted_map_t::find_value(const value_t& key)
+{
+    value_type* entry = find_entry(key);
+    return entry ? &entry->second : nullptr;
+}
+
+inline atom_t::atom_t(const value_t& value)
+    : m_state(std::make_shared<state_t>(state_t{ std::make_shared<const value_t>(value) }))
+{
+}
+
+inline value_t atom_t::deref() const
+{
+    return *load();
+}
+
+inline value_t atom_t::reset(const value_t& value) const
+{
+    std::atomic_store(&m_state->m_value, std::make_shared<const value_t>(value));
+    return value;
+}
+
+inline bool atom_t::compare_and_set(const pointer& expected, const value_t& value) const
+{
+    pointer current = expected;
+    return std::atomic_compare_exchange_strong(&m_state->m_value, &current, std::make_shared<const value_t>(value));
+}
+
+template <class Func>
+value_t atom_t::swap(Func&& func) const
+{
+    pointer current = load();
+    while (true)
+    {
+        pointer next = std::make_shared<const value_t>(std::invoke(func, *current));
+        if (std::atomic_compare_exchange_weak(&m_state->m_value, &current, next))
+        {
+            return *next;
+        }
+    }
+}
+
+struct future_t::state_t
+{
+    mutable std::mutex m_mutex;
+    std::condition_variable m_ready;
+    std::optional<value_t> m_value;
+    std::exception_ptr m_error;
+
+    bool is_ready() const { return m_value || m_error; }
+};
+
+inline future_t::future_t() : m_state(std::make_shared<state_t>())
+{
+}
+
+inline bool future_t::deliver(const value_t& value) const
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_state->m_mutex };
+        if (m_state->is_ready())
+        {
+            return false;
+        }
+        m_state->m_value = value;
+    }
+    m_state->m_ready.notify_all();
+    return true;
+}
+
+inline bool future_t::fail(std::exception_ptr error) const
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_state->m_mutex };
+        if (m_state->is_ready())
+        {
+            return false;
+        }
+        m_state->m_error = std::move(error);
+    }
+    m_state->m_ready.notify_all();
+    return true;
+}
+
+inline bool future_t::is_ready() const
+{
+    std::lock_guard<std::mutex> lock{ m_state->m_mutex };
+    return m_state->is_ready();
+}
+
+template <class Rep, class Period>
+bool future_t::wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+{
+    std::unique_lock<std::mutex> lock{ m_state->m_mutex };
+    return m_state->m_ready.wait_for(lock, timeout, [&]() { return m_state->is_ready(); });
+}
+
+inline void future_t::wait() const
+{
+    std::unique_lock<std::mutex> lock{ m_state->m_mutex };
+    m_state->m_ready.wait(lock, [&]() { return m_state->is_ready(); });
+}
+
+inline value_t future_t::deref() const
+{
+    wait();
+    std::lock_guard<std::mutex> lock{ m_state->m_mutex };
+    if (m_state->m_error)
+    {
+        std::rethrow_exception(m_state->m_error);
+    }
+    return *m_state->m_value;
+}
+
 namespace detail
 {
 
@@ -587,6 +1058,28 @@ struct print_visitor
     void operator()(const tagged_element_t& v) const { os << v; }
     void operator()(const quoted_element_t& v) const { os << v; }
     void operator()(const callable_t& v) const { os << v; }
+    void operator()(const atom_t& v) const { os << v; }
+    void operator()(const future_t& v) const { os << v; }
+    void operator()(const sorted_set_t& v) const { os << v; }
+    void operator()(const sorted_map_t& v) const { os << v; }
+};
+
+// True for collections of the same type whose cached hashes prove them different.
+struct hash_mismatch_visitor
+{
+    template <class T>
+    bool operator()(const box_t<T>& lhs, const box_t<T>& rhs) const
+    {
+        const auto lhs_hash = lhs.m_hash.load();
+        const auto rhs_hash = lhs_hash && lhs_hash->second ? rhs.m_hash.load() : std::nullopt;
+        return rhs_hash && rhs_hash->second && lhs_hash->first != rhs_hash->first;
+    }
+
+    template <class L, class R>
+    bool operator()(const L&, const R&) const
+    {
+        return false;
+    }
 };
 
 struct eq_visitor
@@ -611,6 +1104,16 @@ struct eq_visitor
         return std::tie(lt.tag(), lt.element()) == std::tie(rt.tag(), rt.element());
     }
     bool operator()(const quoted_element_t& lt, const quoted_element_t& rt) const { return lt.element() == rt.element(); }
+    bool operator()(const atom_t& lt, const atom_t& rt) const { return lt == rt; }
+    bool operator()(const future_t& lt, const future_t& rt) const { return lt == rt; }
+    bool operator()(const sorted_set_t& lt, const sorted_set_t& rt) const
+    {
+        return lt.size() == rt.size() && std::equal(lt.begin(), lt.end(), rt.begin());
+    }
+    bool operator()(const sorted_map_t& lt, const sorted_map_t& rt) const
+    {
+        return lt.size() == rt.size() && std::equal(lt.begin(), lt.end(), rt.begin());
+    }
 
     template <class L, class R>
     bool operator()(const L&, const R&) const
@@ -638,6 +1141,16 @@ struct lt_visitor
         return std::tie(lt.tag(), lt.element()) < std::tie(rt.tag(), rt.element());
     }
     bool operator()(const quoted_element_t& lt, const quoted_element_t& rt) const { return lt.element() < rt.element(); }
+    bool operator()(const atom_t& lt, const atom_t& rt) const { return lt < rt; }
+    bool operator()(const future_t& lt, const future_t& rt) const { return lt < rt; }
+    bool operator()(const sorted_set_t& lt, const sorted_set_t& rt) const
+    {
+        return std::lexicographical_compare(lt.begin(), lt.end(), rt.begin(), rt.end());
+    }
+    bool operator()(const sorted_map_t& lt, const sorted_map_t& rt) const
+    {
+        return std::lexicographical_compare(lt.begin(), lt.end(), rt.begin(), rt.end());
+    }
 
     template <class L, class R>
     bool operator()(const L&, const R&) const
@@ -646,6 +1159,71 @@ struct lt_visitor
     }
 };
 
+struct cmp_visitor
+{
+    template <class T>
+    static int three_way(const T& lt, const T& rt)
+    {
+        return lt < rt ? -1 : rt < lt ? 1 : 0;
+    }
+
+    static int three_way(const value_t& lt, const value_t& rt) { return compare(lt, rt); }
+
+    template <class L, class R>
+    static int three_way(const std::pair<L, R>& lt, const std::pair<L, R>& rt)
+    {
+        const int first = three_way(lt.first, rt.first);
+        return first != 0 ? first : three_way(lt.second, rt.second);
+    }
+
+    template <class Range>
+    static int lexicographical(const Range& lt, const Range& rt)
+    {
+        auto l = lt.begin();
+        auto r = rt.begin();
+        for (; l != lt.end() && r != rt.end(); ++l, ++r)
+        {
+            if (const int result = three_way(*l, *r); result != 0)
+            {
+                return result;
+            }
+        }
+        return l == lt.end() ? (r == rt.end() ? 0 : -1) : 1;
+    }
+
+    int operator()(nil_t, nil_t) const { return 0; }
+    int operator()(boolean_t lt, boolean_t rt) const { return three_way(lt, rt); }
+    int operator()(character_t lt, character_t rt) const { return three_way(lt, rt); }
+    int operator()(integer_t lt, integer_t rt) const { return three_way(lt, rt); }
+    int operator()(floating_point_t lt, floating_point_t rt) const { return three_way(lt, rt); }
+    int operator()(const string_t& lt, const string_t& rt) const { return lt.compare(rt); }
+    int operator()(const symbol_t& lt, const symbol_t& rt) const { return lt.compare(rt); }
+    int operator()(const keyword_t& lt, const keyword_t& rt) const { return lt.compare(rt); }
+    int operator()(const list_t& lt, const list_t& rt) const { return lexicographical(lt, rt); }
+    int operator()(const vector_t& lt, const vector_t& rt) const { return lexicographical(lt, rt); }
+    int operator()(const set_t& lt, const set_t& rt) const { return lexicographical(lt, rt); }
+    int operator()(const map_t& lt, const map_t& rt) const { return lexicographical(lt, rt); }
+    int operator()(const sorted_set_t& lt, const sorted_set_t& rt) const { return lexicographical(lt, rt); }
+    int operator()(const sorted_map_t& lt, const sorted_map_t& rt) const { return lexicographical(lt, rt); }
+    int operator()(const tagged_element_t& lt, const tagged_element_t& rt) const
+    {
+        const int tag = lt.tag().compare(rt.tag());
+        return tag != 0 ? tag : compare(lt.element(), rt.element());
+    }
+    int operator()(const quoted_element_t& lt, const quoted_element_t& rt) const
+    {
+        return compare(lt.element(), rt.element());
+    }
+    int operator()(const atom_t& lt, const atom_t& rt) const { return three_way(lt, rt); }
+    int operator()(const future_t& lt, const future_t& rt) const { return three_way(lt, rt); }
+
+    template <class L, class R>
+    int operator()(const L&, const R&) const
+    {
+        return 0;
+    }
+};
+
 }  // namespace detail
 
 inline std::ostream& operator<<(std::ostream& os, const value_t& item)
@@ -656,14 +1234,37 @@ inline std::ostream& operator<<(std::ostream& os, const value_t& item)
 
 inline constexpr bool operator==(const value_t& lhs, const value_t& rhs)
 {
+    if (std::visit(detail::hash_mismatch_visitor{}, lhs.m_data, rhs.m_data))
+    {
+        return false;
+    }
     return std::visit(unboxing_visitor{ detail::eq_visitor{} }, lhs.m_data, rhs.m_data);
 }
 
+inline constexpr bool operator!=(const value_t& lhs, const value_t& rhs)
+{
+    return !(lhs == rhs);
+}
+
+// Values of different types are ordered by type, so that sorting and set_t see a strict weak ordering.
 inline constexpr bool operator<(const value_t& lhs, const value_t& rhs)
 {
+    if (lhs.m_data.index() != rhs.m_data.index())
+    {
+        return lhs.m_data.index() < rhs.m_data.index();
+    }
     return std::visit(unboxing_visitor{ detail::lt_visitor{} }, lhs.m_data, rhs.m_data);
 }
 
+inline int compare_fn::operator()(const value_t& lhs, const value_t& rhs) const
+{
+    if (lhs.m_data.index() != rhs.m_data.index())
+    {
+        return lhs.m_data.index() < rhs.m_data.index() ? -1 : 1;
+    }
+    return std::visit(unboxing_visitor{ detail::cmp_visitor{} }, lhs.m_data, rhs.m_data);
+}
+
 inline constexpr bool operator>(const value_t& lhs, const value_t& rhs)
 {
     return rhs < lhs;
@@ -679,6 +1280,121 @@ inline constexpr bool operator>=(const value_t& lhs, const value_t& rhs)
     return !(lhs < rhs);
 }
 
+// Builders accumulate elements in a flat buffer and produce the immutable collection in a single pass, moving the
+// elements instead of copying them and avoiding the per-insert lookups of set_t and map_t.
+class vector_builder
+{
+    vector_t m_items;
+
+public:
+    vector_builder() = default;
+
+    explicit vector_builder(std::size_t capacity) { m_items.reserve(capacity); }
+
+    std::size_t size() const { return m_items.size(); }
+
+    void reserve(std::size_t capacity) { m_items.reserve(capacity); }
+
+    vector_builder& push_back(value_t item)
+    {
+        m_items.push_back(std::move(item));
+        return *this;
+    }
+
+    value_t build() && { return std::move(m_items); }
+};
+
+class set_builder
+{
+    std::vector<value_t> m_items;
+
+public:
+    set_builder() = default;
+
+    explicit set_builder(std::size_t capacity) { m_items.reserve(capacity); }
+
+    std::size_t size() const { return m_items.size(); }
+
+    void reserve(std::size_t capacity) { m_items.reserve(capacity); }
+
+    set_builder& insert(value_t item)
+    {
+        m_items.push_back(std::move(item));
+        return *this;
+    }
+
+    // Sorts and deduplicates, then fills the set from the sorted range, which std::set does in linear time.
+    value_t build() &&
+    {
+        std::sort(m_items.begin(), m_items.end());
+        const auto last = std::unique(
+            m_items.begin(), m_items.end(), [](const value_t& lhs, const value_t& rhs) { return !(lhs < rhs); });
+        return set_t{ std::make_move_iterator(m_items.begin()), std::make_move_iterator(last) };
+    }
+};
+
+class map_builder
+{
+    std::vector<map_t::value_type> m_items;
+
+public:
+    map_builder() = default;
+
+    explicit map_builder(std::size_t capacity) { m_items.reserve(capacity); }
+
+    std::size_t size() const { return m_items.size(); }
+
+    void reserve(std::size_t capacity) { m_items.reserve(capacity); }
+
+    map_builder& insert(value_t key, value_t value)
+    {
+        m_items.emplace_back(std::move(key), std::move(value));
+        return *this;
+    }
+
+    // Keeps insertion order. A repeated key stays at the position of its first occurrence and takes the last value,
+    // matching repeated `map_t::operator[]` assignments.
+    value_t build() &&
+    {
+        std::vector<std::size_t> order(m_items.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(
+            order.begin(),
+            order.end(),
+            [&](std::size_t lhs, std::size_t rhs) { return m_items[lhs].first < m_items[rhs].first; });
+
+        std::vector<bool> removed(m_items.size(), false);
+        for (std::size_t i = 0; i < order.size();)
+        {
+            std::size_t j = i + 1;
+            while (j < order.size() && !(m_items[order[i]].first < m_items[order[j]].first))
+            {
+                removed[order[j]] = true;
+                ++j;
+            }
+            if (j - i > 1)
+            {
+                m_items[order[i]].second = std::move(m_items[order[j - 1]].second);
+            }
+            i = j;
+        }
+
+        map_t result = {};
+        result.m_items.reserve(m_items.size());
+        for (std::size_t i = 0; i < m_items.size(); ++i)
+        {
+            if (!removed[i])
+            {
+                result.m_items.push_back(std::move(m_items[i]));
+            }
+        }
+        return result;
+    }
+};
+
 namespace ansi
 {
 constexpr std::string_view reset = "\033[0m";
@@ -786,7 +1502,8 @@ class pretty_printer
 
     static bool is_simple_value(const value_t& item)
     {
-        return !item.if_list() && !item.if_vector() && !item.if_set() && !item.if_map();
+        return !item.if_list() && !item.if_vector() && !item.if_set() && !item.if_map() && !item.if_sorted_set()
+               && !item.if_sorted_map();
     }
 
     std::size_t estimate_length(const value_t& item) const
@@ -884,7 +1601,8 @@ class pretty_printer
         m_os << write_ansi(&color_scheme::parenthesis) << ")" << write_ansi(&color_scheme::reset);
     }
 
-    void print(const set_t& item, bool inline_mode)
+    template <class Set>
+    void print_set(const Set& item, bool inline_mode)
     {
         m_os << write_ansi(&color_scheme::brace) << "#{" << write_ansi(&color_scheme::reset);
 
@@ -922,7 +1640,8 @@ class pretty_printer
         m_os << write_ansi(&color_scheme::brace) << "}" << write_ansi(&color_scheme::reset);
     }
 
-    void print(const map_t& item, bool inline_mode)
+    template <class Map>
+    void print_map(const Map& item, bool inline_mode)
     {
         m_os << write_ansi(&color_scheme::brace) << "{" << write_ansi(&color_scheme::reset);
 
@@ -981,11 +1700,19 @@ class pretty_printer
         }
         else if (const auto maybe_set = item.if_set())
         {
-            print(*maybe_set, inline_mode);
+            print_set(*maybe_set, inline_mode);
         }
         else if (const auto maybe_map = item.if_map())
         {
-            print(*maybe_map, inline_mode);
+            print_map(*maybe_map, inline_mode);
+        }
+        else if (const auto maybe_sorted_set = item.if_sorted_set())
+        {
+            print_set(*maybe_sorted_set, inline_mode);
+        }
+        else if (const auto maybe_sorted_map = item.if_sorted_map())
+        {
+            print_map(*maybe_sorted_map, inline_mode);
         }
         else if (const auto maybe_tagged_element = item.if_tagged_element())
         {
@@ -1040,6 +1767,24 @@ struct location_t
     }
 };
 
+// Source range (byte offsets, end exclusive) of a parsed value. The spans of the elements of a collection are listed
+// in source order and are relative to the beginning of the collection, so that an edit only shifts its siblings.
+struct span_t
+{
+    std::size_t m_begin = 0;
+    std::size_t m_end = 0;
+    std::vector<span_t> m_children = {};
+
+    std::size_t size() const { return m_end - m_begin; }
+
+    friend bool operator==(const span_t& lhs, const span_t& rhs)
+    {
+        return lhs.m_begin == rhs.m_begin && lhs.m_end == rhs.m_end && lhs.m_children == rhs.m_children;
+    }
+
+    friend bool operator!=(const span_t& lhs, const span_t& rhs) { return !(lhs == rhs); }
+};
+
 class parse_error : public std::runtime_error
 {
 public:
@@ -1076,6 +1821,11 @@ class stream_t
 public:
     stream_t(std::string_view content) : m_content(content) { }
 
+    // For content taken from the middle of a larger text, so that errors report positions in that text.
+    stream_t(std::string_view content, location_t start) : m_content(content), m_location(start) { }
+
+    std::size_t position() const { return m_pos; }
+
     bool eof() const { return m_pos >= m_content.size(); }
 
     char_t peek() const
@@ -1135,6 +1885,7 @@ public:
 class parser_t
 {
     stream_t& m_stream;
+    std::vector<span_t>* m_spans = nullptr;
 
     bool is_delimiter(char ch) const
     {
@@ -1339,7 +2090,12 @@ class parser_t
     value_t parse_set()
     {
         vector_t items = parse_collection<vector_t>('{', '}', "Unterminated set").first;
-        return set_t{ items.begin(), items.end() };
+        set_builder result{ items.size() };
+        for (value_t& item : items)
+        {
+            result.insert(std::move(item));
+        }
+        return std::move(result).build();
     }
 
     value_t parse_map()
@@ -1351,12 +2107,12 @@ class parser_t
             throw parse_error("Map requires an even number of elements", start_loc);
         }
 
-        map_t result = {};
+        map_builder result{ items.size() / 2 };
         for (std::size_t i = 0; i < items.size(); i += 2)
         {
-            result[items[i + 0]] = items[i + 1];
+            result.insert(std::move(items[i + 0]), std::move(items[i + 1]));
         }
-        return result;
+        return std::move(result).build();
     }
 
     value_t parse_hash()
@@ -1375,7 +2131,6 @@ class parser_t
 
         if (next == '{')
         {
-            m_stream.get();  // consume '{'
             return parse_set();
         }
         else
@@ -1404,7 +2159,43 @@ class parser_t
 public:
     parser_t(stream_t& stream) : m_stream(stream) { }
 
+    // Appends the span of every top-level value read by this parser to `spans`.
+    parser_t(stream_t& stream, std::vector<span_t>& spans) : m_stream(stream), m_spans(&spans) { }
+
     value_t parse_value()
+    {
+        if (!m_spans)
+        {
+            return parse_form();
+        }
+        m_stream.skip_whitespace_and_comments();
+        std::vector<span_t>* const parent = m_spans;
+        span_t span = {};
+        span.m_begin = m_stream.position();
+        m_spans = &span.m_children;
+        value_t result = {};
+        try
+        {
+            result = parse_form();
+        }
+        catch (...)
+        {
+            m_spans = parent;
+            throw;
+        }
+        m_spans = parent;
+        span.m_end = m_stream.position();
+        for (span_t& child : span.m_children)
+        {
+            child.m_begin -= span.m_begin;
+            child.m_end -= span.m_begin;
+        }
+        m_spans->push_back(std::move(span));
+        return result;
+    }
+
+private:
+    value_t parse_form()
     {
         using parse_fn = value_t (parser_t::*)();
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <edn/frozen.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace edn
+{
+
+// A frozen block compiled into the program by the edn_embed() CMake function, which generates a function returning
+// it for every embedded file. The block is validated once, when the function is first called; root() then reads it
+// in place, and thaw() materializes an editable tree in one pass without parsing text.
+class embedded_t
+{
+public:
+    embedded_t(const std::uint64_t* data, std::size_t size) : m_data(data), m_size(size), m_root(frozen_root(data, size))
+    {
+    }
+
+    const void* data() const { return m_data; }
+
+    std::size_t size() const { return m_size; }
+
+    const frozen_value_t& root() const { return m_root; }
+
+    value_t thaw() const { return m_root.thaw(); }
+
+private:
+    const std::uint64_t* m_data;
+    std::size_t m_size;
+    frozen_value_t m_root;
+};
+
+}  // namespace edn
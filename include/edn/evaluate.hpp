@@ -3,6 +3,8 @@
 #pragma once
 
 #include <edn/edn.hpp>
+#include <edn/gc.hpp>
+#include <edn/thread_pool.hpp>
 #include <map>
 #include <numeric>
 #include <optional>
@@ -15,6 +17,8 @@ struct stack_t
     using frame_type = std::map<symbol_t, value_t>;
     frame_type m_frame;
     stack_t* m_outer;
+    // Optional collector for the atoms and futures created while evaluating in this stack and its inner scopes.
+    gc_heap* m_heap = nullptr;
 
     stack_t(frame_type frame, stack_t* outer) : m_frame{ std::move(frame) }, m_outer{ outer } { }
 
@@ -42,6 +46,21 @@ struct stack_t
     }
 
     const value_t& operator[](const symbol_t& symbol) const { return get(symbol); }
+
+    gc_heap* heap() const { return m_heap ? m_heap : m_outer ? m_outer->heap() : nullptr; }
+
+    template <class Func>
+    void for_each_value(Func&& func) const
+    {
+        for (const auto& [symbol, value] : m_frame)
+        {
+            func(value);
+        }
+        if (m_outer)
+        {
+            m_outer->for_each_value(func);
+        }
+    }
 };
 
 constexpr inline struct evaluate_fn
@@ -87,21 +106,21 @@ private:
         }
         else if (auto maybe_set = value.if_set())
         {
-            set_t res = {};
+            set_builder res{ maybe_set->size() };
             for (const value_t& item : *maybe_set)
             {
                 res.insert(do_eval(item, stack));
             }
-            return res;
+            return std::move(res).build();
         }
         else if (auto maybe_map = value.if_map())
         {
-            map_t res = {};
+            map_builder res{ maybe_map->size() };
             for (const auto& [key, val] : *maybe_map)
             {
-                res.emplace(do_eval(key, stack), do_eval(val, stack));
+                res.insert(do_eval(key, stack), do_eval(val, stack));
             }
-            return res;
+            return std::move(res).build();
         }
         return value;
     }
@@ -267,6 +286,181 @@ private:
 
     auto eval_quote(const std::vector<value_t>& input, stack_t&) const -> value_t { return input[0]; }
 
+    auto eval_atom_ref(const value_t& value, stack_t& stack) const -> atom_t
+    {
+        const value_t result = do_eval(value, stack);
+        if (const auto maybe_atom = result.if_atom())
+        {
+            return *maybe_atom;
+        }
+        throw std::runtime_error{ str("expected atom, got ", result.type()) };
+    }
+
+    template <class Ref>
+    static auto track(Ref ref, stack_t& stack) -> value_t
+    {
+        if (gc_heap* heap = stack.heap())
+        {
+            if (heap->collection_due())
+            {
+                heap->collect(stack);
+            }
+            return heap->track(std::move(ref));
+        }
+        return ref;
+    }
+
+    auto eval_atom(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        return track(atom_t{ do_eval(input.at(0), stack) }, stack);
+    }
+
+    auto eval_deref(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        const value_t ref = do_eval(input.at(0), stack);
+        if (const auto maybe_future = ref.if_future())
+        {
+            return thread_pool::default_pool().deref(*maybe_future);
+        }
+        if (const auto maybe_atom = ref.if_atom())
+        {
+            return maybe_atom->deref();
+        }
+        throw std::runtime_error{ str("cannot deref ", ref.type()) };
+    }
+
+    auto eval_reset(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        return eval_atom_ref(input.at(0), stack).reset(do_eval(input.at(1), stack));
+    }
+
+    // The body is evaluated on the shared thread pool against the enclosing stack, which therefore has to outlive the
+    // future; deref it before leaving the scope that created it.
+    auto eval_future(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        return track(
+            thread_pool::default_pool().async([this, body = input, &stack]() { return eval_block(body, stack); }), stack);
+    }
+
+    auto eval_promise(const std::vector<value_t>&, stack_t& stack) const -> value_t { return track(future_t{}, stack); }
+
+    auto eval_deliver(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        const value_t ref = do_eval(input.at(0), stack);
+        const auto maybe_future = ref.if_future();
+        if (!maybe_future)
+        {
+            throw std::runtime_error{ str("expected promise, got ", ref.type()) };
+        }
+        return maybe_future->deliver(do_eval(input.at(1), stack)) ? ref : value_t{};
+    }
+
+    auto eval_sorted_set(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        sorted_set_t res = {};
+        for (const value_t& item : input)
+        {
+            res.insert(do_eval(item, stack));
+        }
+        return res;
+    }
+
+    auto eval_sorted_map(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        sorted_map_t res = {};
+        for (std::size_t i = 0; i < input.size(); i += 2)
+        {
+            res.insert_or_assign(do_eval(input.at(i + 0), stack), do_eval(input.at(i + 1), stack));
+        }
+        return res;
+    }
+
+    // Range tests are given as the comparison symbols and are not evaluated: (subseq coll > 10 <= 20).
+    static auto to_range_test(const value_t& value) -> range_test
+    {
+        static const std::map<symbol_t, range_test> tests = {
+            { symbol_t{ "<" }, range_test::lt },
+            { symbol_t{ "<=" }, range_test::le },
+            { symbol_t{ ">" }, range_test::gt },
+            { symbol_t{ ">=" }, range_test::ge },
+        };
+        if (const auto maybe_symbol = value.if_symbol())
+        {
+            if (const auto it = tests.find(*maybe_symbol); it != tests.end())
+            {
+                return it->second;
+            }
+        }
+        throw std::runtime_error{ str("expected one of <, <=, >, >=, got `", value, "`") };
+    }
+
+    template <class Range>
+    static auto range_to_list(const Range& range) -> list_t
+    {
+        list_t res = {};
+        for (const auto& item : range)
+        {
+            if constexpr (std::is_same_v<std::decay_t<decltype(item)>, value_t>)
+            {
+                res.push_back(item);
+            }
+            else
+            {
+                res.push_back(vector_t{ item.first, item.second });
+            }
+        }
+        return res;
+    }
+
+    template <bool Reverse>
+    auto eval_range(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        const value_t coll = do_eval(input.at(0), stack);
+        const auto select = [&](const auto& sorted) -> value_t
+        {
+            if (input.size() == 3)
+            {
+                const auto test = to_range_test(input.at(1));
+                const value_t key = do_eval(input.at(2), stack);
+                return Reverse ? range_to_list(sorted.rsubseq(test, key)) : range_to_list(sorted.subseq(test, key));
+            }
+            const auto start_test = to_range_test(input.at(1));
+            const value_t start_key = do_eval(input.at(2), stack);
+            const auto end_test = to_range_test(input.at(3));
+            const value_t end_key = do_eval(input.at(4), stack);
+            return Reverse ? range_to_list(sorted.rsubseq(start_test, start_key, end_test, end_key))
+                           : range_to_list(sorted.subseq(start_test, start_key, end_test, end_key));
+        };
+        if (const auto maybe_sorted_set = coll.if_sorted_set())
+        {
+            return select(*maybe_sorted_set);
+        }
+        if (const auto maybe_sorted_map = coll.if_sorted_map())
+        {
+            return select(*maybe_sorted_map);
+        }
+        throw std::runtime_error{ str("expected sorted collection, got ", coll.type()) };
+    }
+
+    auto eval_swap(const std::vector<value_t>& input, stack_t& stack) const -> value_t
+    {
+        const atom_t atom = eval_atom_ref(input.at(0), stack);
+        const callable_t callable = *do_eval(input.at(1), stack).if_callable();
+        std::vector<value_t> args;
+        args.reserve(input.size() - 1);
+        args.push_back(value_t{});
+        for (auto it = input.begin() + 2; it != input.end(); ++it)
+        {
+            args.push_back(do_eval(*it, stack));
+        }
+        return atom.swap(
+            [&](const value_t& current) -> value_t
+            {
+                args[0] = current;
+                return callable(args);
+            });
+    }
+
     auto eval_list(const list_t& input, stack_t& stack) const -> value_t
     {
         if (input.empty())
@@ -279,14 +473,25 @@ private:
         using handler_t = value_t (evaluate_fn::*)(const std::vector<value_t>&, stack_t&) const;
 
         static const std::map<symbol_t, handler_t> handlers = {
-            { symbol_t{ "quote" }, &evaluate_fn::eval_quote },  //
-            { symbol_t{ "let" }, &evaluate_fn::eval_let },      //
-            { symbol_t{ "def" }, &evaluate_fn::eval_def },      //
-            { symbol_t{ "fn" }, &evaluate_fn::eval_fn },        //
-            { symbol_t{ "defn" }, &evaluate_fn::eval_defn },    //
-            { symbol_t{ "if" }, &evaluate_fn::eval_if },        //
-            { symbol_t{ "cond" }, &evaluate_fn::eval_cond },    //
-            { symbol_t{ "do" }, &evaluate_fn::eval_do },        //
+            { symbol_t{ "quote" }, &evaluate_fn::eval_quote },            //
+            { symbol_t{ "let" }, &evaluate_fn::eval_let },                //
+            { symbol_t{ "def" }, &evaluate_fn::eval_def },                //
+            { symbol_t{ "fn" }, &evaluate_fn::eval_fn },                  //
+            { symbol_t{ "defn" }, &evaluate_fn::eval_defn },              //
+            { symbol_t{ "if" }, &evaluate_fn::eval_if },                  //
+            { symbol_t{ "cond" }, &evaluate_fn::eval_cond },              //
+            { symbol_t{ "do" }, &evaluate_fn::eval_do },                  //
+            { symbol_t{ "atom" }, &evaluate_fn::eval_atom },              //
+            { symbol_t{ "deref" }, &evaluate_fn::eval_deref },            //
+            { symbol_t{ "reset!" }, &evaluate_fn::eval_reset },           //
+            { symbol_t{ "swap!" }, &evaluate_fn::eval_swap },             //
+            { symbol_t{ "future" }, &evaluate_fn::eval_future },          //
+            { symbol_t{ "promise" }, &evaluate_fn::eval_promise },        //
+            { symbol_t{ "deliver" }, &evaluate_fn::eval_deliver },        //
+            { symbol_t{ "sorted-set" }, &evaluate_fn::eval_sorted_set },  //
+            { symbol_t{ "sorted-map" }, &evaluate_fn::eval_sorted_map },  //
+            { symbol_t{ "subseq" }, &evaluate_fn::eval_range<false> },    //
+            { symbol_t{ "rsubseq" }, &evaluate_fn::eval_range<true> },    //
         };
 
         if (const auto h = head.if_symbol())
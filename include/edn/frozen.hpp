@@ -0,0 +1,751 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace edn
+{
+
+namespace detail
+{
+
+// Layout of a frozen block: the header, the node table and the string pool, each starting at a multiple of 8 bytes.
+// All references are indices into the node table or offsets into the string pool, so a block can be copied or mapped
+// anywhere. Integers are stored in the byte order of the machine that froze the tree.
+struct frozen_header_t
+{
+    char m_magic[4];
+    std::uint32_t m_version;
+    std::uint64_t m_node_count;
+    std::uint64_t m_string_bytes;
+};
+
+static constexpr inline char frozen_magic[4] = { 'E', 'D', 'N', 'F' };
+static constexpr inline std::uint32_t frozen_version = 1;
+
+// Collections refer to their elements (keys and values alternating for maps) as a run of consecutive nodes. The run
+// of a collection is written before the runs of its elements, which gives a pre-order layout of sibling runs.
+// Tagged elements have two elements (the tag as a symbol, and the element), quoted elements one.
+struct frozen_node_t
+{
+    std::uint8_t m_type;
+    std::uint8_t m_reserved[3];
+    std::uint32_t m_count;  // elements of collections, entries of maps, bytes of strings
+    union
+    {
+        std::uint64_t m_offset;  // index of the first element, or offset of the string in the pool
+        integer_t m_integer;
+        floating_point_t m_floating_point;
+        boolean_t m_boolean;
+        character_t m_character;
+    };
+};
+
+static_assert(sizeof(frozen_header_t) % 8 == 0);
+static_assert(sizeof(frozen_node_t) == 16);
+
+struct frozen_block_t
+{
+    const frozen_node_t* m_nodes;
+    const char* m_strings;
+};
+
+}  // namespace detail
+
+class frozen_value_t;
+
+// Elements of a frozen vector, list, set or sorted set.
+class frozen_sequence_t
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = frozen_value_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = frozen_value_t;
+
+        iterator(detail::frozen_block_t block, const detail::frozen_node_t* node) : m_block(block), m_node(node) { }
+
+        frozen_value_t operator*() const;
+
+        iterator& operator++()
+        {
+            ++m_node;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) { return lhs.m_node == rhs.m_node; }
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) { return !(lhs == rhs); }
+
+    private:
+        detail::frozen_block_t m_block;
+        const detail::frozen_node_t* m_node;
+    };
+
+    frozen_sequence_t(detail::frozen_block_t block, const detail::frozen_node_t* node) : m_block(block), m_node(node)
+    {
+    }
+
+    std::size_t size() const { return m_node->m_count; }
+
+    bool empty() const { return size() == 0; }
+
+    iterator begin() const { return iterator{ m_block, first() }; }
+
+    iterator end() const { return iterator{ m_block, first() + size() }; }
+
+    frozen_value_t operator[](std::size_t index) const;
+
+    frozen_value_t at(std::size_t index) const;
+
+    // Binary search for sets and sorted sets (elements are frozen in order), linear search otherwise.
+    bool contains(const value_t& item) const;
+
+private:
+    detail::frozen_block_t m_block;
+    const detail::frozen_node_t* m_node;
+
+    const detail::frozen_node_t* first() const { return m_block.m_nodes + m_node->m_offset; }
+};
+
+// Entries of a frozen map or sorted map, in the order of the original.
+class frozen_map_t
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<frozen_value_t, frozen_value_t>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        iterator(detail::frozen_block_t block, const detail::frozen_node_t* node) : m_block(block), m_node(node) { }
+
+        value_type operator*() const;
+
+        iterator& operator++()
+        {
+            m_node += 2;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        friend bool operator==(const iterator& lhs, const iterator& rhs) { return lhs.m_node == rhs.m_node; }
+        friend bool operator!=(const iterator& lhs, const iterator& rhs) { return !(lhs == rhs); }
+
+    private:
+        detail::frozen_block_t m_block;
+        const detail::frozen_node_t* m_node;
+    };
+
+    frozen_map_t(detail::frozen_block_t block, const detail::frozen_node_t* node) : m_block(block), m_node(node) { }
+
+    std::size_t size() const { return m_node->m_count; }
+
+    bool empty() const { return size() == 0; }
+
+    iterator begin() const { return iterator{ m_block, first() }; }
+
+    iterator end() const { return iterator{ m_block, first() + 2 * size() }; }
+
+    // Value stored under `key`: binary search for sorted maps, linear search for maps.
+    std::optional<frozen_value_t> find(const value_t& key) const;
+
+    bool contains(const value_t& key) const;
+
+    frozen_value_t at(const value_t& key) const;
+
+private:
+    detail::frozen_block_t m_block;
+    const detail::frozen_node_t* m_node;
+
+    const detail::frozen_node_t* first() const { return m_block.m_nodes + m_node->m_offset; }
+};
+
+class frozen_tagged_element_t
+{
+public:
+    frozen_tagged_element_t(detail::frozen_block_t block, const detail::frozen_node_t* node)
+        : m_block(block)
+        , m_node(node)
+    {
+    }
+
+    std::string_view tag() const;
+
+    frozen_value_t element() const;
+
+private:
+    detail::frozen_block_t m_block;
+    const detail::frozen_node_t* m_node;
+};
+
+// Read-only view of a value in a frozen block, with the accessors of value_t. Strings are returned as views into the
+// string pool and collections as views of their elements; the block must outlive every view into it.
+class frozen_value_t
+{
+public:
+    frozen_value_t(detail::frozen_block_t block, const detail::frozen_node_t* node) : m_block(block), m_node(node) { }
+
+    value_type_t type() const { return static_cast<value_type_t>(m_node->m_type); }
+
+    bool is_nil() const { return type() == value_type_t::nil; }
+
+    const integer_t* if_integer() const { return is(value_type_t::integer) ? &m_node->m_integer : nullptr; }
+
+    const floating_point_t* if_floating_point() const
+    {
+        return is(value_type_t::floating_point) ? &m_node->m_floating_point : nullptr;
+    }
+
+    const boolean_t* if_boolean() const { return is(value_type_t::boolean) ? &m_node->m_boolean : nullptr; }
+
+    const character_t* if_character() const { return is(value_type_t::character) ? &m_node->m_character : nullptr; }
+
+    std::optional<std::string_view> if_string() const { return text(value_type_t::string); }
+
+    std::optional<std::string_view> if_symbol() const { return text(value_type_t::symbol); }
+
+    std::optional<std::string_view> if_keyword() const { return text(value_type_t::keyword); }
+
+    std::optional<frozen_sequence_t> if_vector() const { return sequence(value_type_t::vector); }
+
+    std::optional<frozen_sequence_t> if_list() const { return sequence(value_type_t::list); }
+
+    std::optional<frozen_sequence_t> if_set() const { return sequence(value_type_t::set); }
+
+    std::optional<frozen_sequence_t> if_sorted_set() const { return sequence(value_type_t::sorted_set); }
+
+    std::optional<frozen_map_t> if_map() const { return map(value_type_t::map); }
+
+    std::optional<frozen_map_t> if_sorted_map() const { return map(value_type_t::sorted_map); }
+
+    std::optional<frozen_tagged_element_t> if_tagged_element() const
+    {
+        if (!is(value_type_t::tagged_element))
+        {
+            return std::nullopt;
+        }
+        return frozen_tagged_element_t{ m_block, m_node };
+    }
+
+    // The quoted element.
+    std::optional<frozen_value_t> if_quoted_element() const
+    {
+        if (!is(value_type_t::quoted_element))
+        {
+            return std::nullopt;
+        }
+        return frozen_value_t{ m_block, m_block.m_nodes + m_node->m_offset };
+    }
+
+    // Copies the value back into an ordinary, mutable tree.
+    value_t thaw() const
+    {
+        switch (type())
+        {
+            case value_type_t::integer: return m_node->m_integer;
+            case value_type_t::floating_point: return m_node->m_floating_point;
+            case value_type_t::boolean: return m_node->m_boolean;
+            case value_type_t::character: return m_node->m_character;
+            case value_type_t::string: return string_t{ string() };
+            case value_type_t::symbol: return symbol_t{ string() };
+            case value_type_t::keyword: return keyword_t{ string() };
+            case value_type_t::vector: return thaw_sequence<vector_t>();
+            case value_type_t::list: return thaw_sequence<list_t>();
+            case value_type_t::set:
+            {
+                set_t result = {};
+                for (const frozen_value_t item : *if_set())
+                {
+                    result.insert(result.end(), item.thaw());
+                }
+                return result;
+            }
+            case value_type_t::sorted_set:
+            {
+                sorted_set_t result = {};
+                for (const frozen_value_t item : *if_sorted_set())
+                {
+                    result.insert(item.thaw());
+                }
+                return result;
+            }
+            case value_type_t::map:
+            {
+                map_t result = {};
+                result.m_items.reserve(m_node->m_count);
+                for (const auto& [key, item] : *if_map())
+                {
+                    result.m_items.emplace_back(key.thaw(), item.thaw());
+                }
+                return result;
+            }
+            case value_type_t::sorted_map:
+            {
+                sorted_map_t result = {};
+                for (const auto& [key, item] : *if_sorted_map())
+                {
+                    result.insert_or_assign(key.thaw(), item.thaw());
+                }
+                return result;
+            }
+            case value_type_t::tagged_element:
+            {
+                const frozen_tagged_element_t tagged = *if_tagged_element();
+                return tagged_element_t{ symbol_t{ tagged.tag() }, tagged.element().thaw() };
+            }
+            case value_type_t::quoted_element: return quoted_element_t{ if_quoted_element()->thaw() };
+            default: return value_t{};
+        }
+    }
+
+    friend bool operator==(const frozen_value_t& lhs, const value_t& rhs) { return lhs.thaw() == rhs; }
+    friend bool operator!=(const frozen_value_t& lhs, const value_t& rhs) { return !(lhs == rhs); }
+
+    friend std::ostream& operator<<(std::ostream& os, const frozen_value_t& item) { return os << item.thaw(); }
+
+private:
+    friend class frozen_tagged_element_t;
+
+    detail::frozen_block_t m_block;
+    const detail::frozen_node_t* m_node;
+
+    bool is(value_type_t type) const { return m_node->m_type == static_cast<std::uint8_t>(type); }
+
+    std::string_view string() const { return std::string_view{ m_block.m_strings + m_node->m_offset, m_node->m_count }; }
+
+    std::optional<std::string_view> text(value_type_t type) const
+    {
+        if (!is(type))
+        {
+            return std::nullopt;
+        }
+        return string();
+    }
+
+    std::optional<frozen_sequence_t> sequence(value_type_t type) const
+    {
+        if (!is(type))
+        {
+            return std::nullopt;
+        }
+        return frozen_sequence_t{ m_block, m_node };
+    }
+
+    std::optional<frozen_map_t> map(value_type_t type) const
+    {
+        if (!is(type))
+        {
+            return std::nullopt;
+        }
+        return frozen_map_t{ m_block, m_node };
+    }
+
+    template <class Sequence>
+    value_t thaw_sequence() const
+    {
+        Sequence result = {};
+        result.reserve(m_node->m_count);
+        for (const frozen_value_t item : frozen_sequence_t{ m_block, m_node })
+        {
+            result.push_back(item.thaw());
+        }
+        return result;
+    }
+};
+
+inline frozen_value_t frozen_sequence_t::iterator::operator*() const
+{
+    return frozen_value_t{ m_block, m_node };
+}
+
+inline frozen_value_t frozen_sequence_t::operator[](std::size_t index) const
+{
+    return frozen_value_t{ m_block, first() + index };
+}
+
+inline frozen_value_t frozen_sequence_t::at(std::size_t index) const
+{
+    if (index >= size())
+    {
+        throw std::out_of_range{ str("frozen: index ", index, " out of range for ", size(), " elements") };
+    }
+    return (*this)[index];
+}
+
+inline bool frozen_sequence_t::contains(const value_t& item) const
+{
+    const auto type = static_cast<value_type_t>(m_node->m_type);
+    if (type != value_type_t::set && type != value_type_t::sorted_set)
+    {
+        for (const frozen_value_t element : *this)
+        {
+            if (element == item)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    std::size_t lo = 0;
+    std::size_t hi = size();
+    while (lo < hi)
+    {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        const int order = compare((*this)[mid].thaw(), item);
+        if (order == 0)
+        {
+            return true;
+        }
+        if (order < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return false;
+}
+
+inline frozen_map_t::iterator::value_type frozen_map_t::iterator::operator*() const
+{
+    return value_type{ frozen_value_t{ m_block, m_node }, frozen_value_t{ m_block, m_node + 1 } };
+}
+
+inline std::optional<frozen_value_t> frozen_map_t::find(const value_t& key) const
+{
+    const detail::frozen_node_t* const entries = first();
+    const auto entry = [&](std::size_t index) { return frozen_value_t{ m_block, entries + 2 * index }; };
+    const auto value = [&](std::size_t index) { return frozen_value_t{ m_block, entries + 2 * index + 1 }; };
+    if (static_cast<value_type_t>(m_node->m_type) != value_type_t::sorted_map)
+    {
+        for (std::size_t i = 0; i < size(); ++i)
+        {
+            if (entry(i) == key)
+            {
+                return value(i);
+            }
+        }
+        return std::nullopt;
+    }
+    std::size_t lo = 0;
+    std::size_t hi = size();
+    while (lo < hi)
+    {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        const int order = compare(entry(mid).thaw(), key);
+        if (order == 0)
+        {
+            return value(mid);
+        }
+        if (order < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return std::nullopt;
+}
+
+inline bool frozen_map_t::contains(const value_t& key) const
+{
+    return find(key).has_value();
+}
+
+inline frozen_value_t frozen_map_t::at(const value_t& key) const
+{
+    if (const auto result = find(key))
+    {
+        return *result;
+    }
+    throw std::out_of_range{ str("frozen: key not found: ", key) };
+}
+
+inline std::string_view frozen_tagged_element_t::tag() const
+{
+    return frozen_value_t{ m_block, m_block.m_nodes + m_node->m_offset }.string();
+}
+
+inline frozen_value_t frozen_tagged_element_t::element() const
+{
+    return frozen_value_t{ m_block, m_block.m_nodes + m_node->m_offset + 1 };
+}
+
+namespace detail
+{
+
+class freezer_t
+{
+public:
+    std::vector<std::uint64_t> run(const value_t& root)
+    {
+        m_nodes.emplace_back();
+        write(0, root);
+
+        const frozen_header_t header = { { frozen_magic[0], frozen_magic[1], frozen_magic[2], frozen_magic[3] },
+                                         frozen_version,
+                                         m_nodes.size(),
+                                         m_strings.size() };
+        const std::size_t node_bytes = m_nodes.size() * sizeof(frozen_node_t);
+        std::vector<std::uint64_t> block((sizeof(header) + node_bytes + m_strings.size() + 7) / 8);
+        char* const out = reinterpret_cast<char*>(block.data());
+        std::memcpy(out, &header, sizeof(header));
+        std::memcpy(out + sizeof(header), m_nodes.data(), node_bytes);
+        std::memcpy(out + sizeof(header) + node_bytes, m_strings.data(), m_strings.size());
+        return block;
+    }
+
+private:
+    std::vector<frozen_node_t> m_nodes;
+    std::string m_strings;
+    // Views into the tree being frozen, which outlives the freezer.
+    std::unordered_map<std::string_view, std::uint64_t> m_string_offsets;
+
+    static std::uint32_t count(std::size_t n)
+    {
+        if (n > std::numeric_limits<std::uint32_t>::max())
+        {
+            throw std::length_error{ str("freeze: ", n, " elements exceed the frozen format") };
+        }
+        return static_cast<std::uint32_t>(n);
+    }
+
+    void write(std::size_t index, const value_t& value)
+    {
+        frozen_node_t node = {};
+        node.m_type = static_cast<std::uint8_t>(value.type());
+        std::visit(unboxing_visitor{ [&](const auto& item) { content(node, item); } }, value.m_data);
+        m_nodes[index] = node;
+    }
+
+    void content(frozen_node_t&, nil_t) { }
+    void content(frozen_node_t& node, integer_t v) { node.m_integer = v; }
+    void content(frozen_node_t& node, floating_point_t v) { node.m_floating_point = v; }
+    void content(frozen_node_t& node, boolean_t v) { node.m_boolean = v; }
+    void content(frozen_node_t& node, character_t v) { node.m_character = v; }
+    void content(frozen_node_t& node, const string_t& v) { string(node, v); }
+    void content(frozen_node_t& node, const symbol_t& v) { string(node, v); }
+    void content(frozen_node_t& node, const keyword_t& v) { string(node, v); }
+    void content(frozen_node_t& node, const vector_t& v) { sequence(node, v); }
+    void content(frozen_node_t& node, const list_t& v) { sequence(node, v); }
+    void content(frozen_node_t& node, const set_t& v) { sequence(node, v); }
+    void content(frozen_node_t& node, const sorted_set_t& v) { sequence(node, v); }
+    void content(frozen_node_t& node, const map_t& v) { entries(node, v); }
+    void content(frozen_node_t& node, const sorted_map_t& v) { entries(node, v); }
+
+    void content(frozen_node_t& node, const tagged_element_t& v)
+    {
+        const std::size_t first = reserve(node, 2, 2);
+        frozen_node_t tag = {};
+        tag.m_type = static_cast<std::uint8_t>(value_type_t::symbol);
+        string(tag, v.tag());
+        m_nodes[first] = tag;
+        write(first + 1, v.element());
+    }
+
+    void content(frozen_node_t& node, const quoted_element_t& v) { write(reserve(node, 1, 1), v.element()); }
+
+    void content(frozen_node_t&, const callable_t&) { unsupported(value_type_t::callable); }
+    void content(frozen_node_t&, const atom_t&) { unsupported(value_type_t::atom); }
+    void content(frozen_node_t&, const future_t&) { unsupported(value_type_t::future); }
+
+    [[noreturn]] static void unsupported(value_type_t type)
+    {
+        throw std::runtime_error{ str("freeze: cannot freeze ", type) };
+    }
+
+    void string(frozen_node_t& node, std::string_view v)
+    {
+        node.m_count = count(v.size());
+        const auto [it, inserted] = m_string_offsets.try_emplace(v, m_strings.size());
+        if (inserted)
+        {
+            m_strings.append(v);
+        }
+        node.m_offset = it->second;
+    }
+
+    // Appends a run of `nodes` nodes for the elements of `node` and returns the index of the first one.
+    std::size_t reserve(frozen_node_t& node, std::size_t elements, std::size_t nodes)
+    {
+        node.m_count = count(elements);
+        node.m_offset = m_nodes.size();
+        m_nodes.resize(m_nodes.size() + nodes);
+        return static_cast<std::size_t>(node.m_offset);
+    }
+
+    template <class Range>
+    void sequence(frozen_node_t& node, const Range& range)
+    {
+        std::size_t index = reserve(node, range.size(), range.size());
+        for (const value_t& item : range)
+        {
+            write(index++, item);
+        }
+    }
+
+    template <class Range>
+    void entries(frozen_node_t& node, const Range& range)
+    {
+        std::size_t index = reserve(node, range.size(), 2 * range.size());
+        for (const auto& [key, item] : range)
+        {
+            write(index++, key);
+            write(index++, item);
+        }
+    }
+};
+
+inline bool is_string_type(value_type_t type)
+{
+    return type == value_type_t::string || type == value_type_t::symbol || type == value_type_t::keyword;
+}
+
+// Checks that every reference of the block stays within it and points forward, so that views cannot read outside the
+// block or loop.
+inline frozen_block_t validate_frozen(const void* data, std::size_t size)
+{
+    if (reinterpret_cast<std::uintptr_t>(data) % alignof(std::uint64_t) != 0)
+    {
+        throw std::runtime_error{ "frozen: block is not 8-byte aligned" };
+    }
+    frozen_header_t header = {};
+    if (size < sizeof(header))
+    {
+        throw std::runtime_error{ "frozen: block too small" };
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.m_magic, frozen_magic, sizeof(frozen_magic)) != 0 || header.m_version != frozen_version)
+    {
+        throw std::runtime_error{ "frozen: not a frozen block of a supported version" };
+    }
+    const std::uint64_t capacity = (size - sizeof(header)) / sizeof(frozen_node_t);
+    if (header.m_node_count == 0 || header.m_node_count > capacity
+        || header.m_string_bytes > size - sizeof(header) - header.m_node_count * sizeof(frozen_node_t))
+    {
+        throw std::runtime_error{ "frozen: block truncated" };
+    }
+
+    const char* const bytes = static_cast<const char*>(data);
+    const frozen_block_t block
+        = { reinterpret_cast<const frozen_node_t*>(bytes + sizeof(header)),
+            bytes + sizeof(header) + header.m_node_count * sizeof(frozen_node_t) };
+    for (std::uint64_t i = 0; i < header.m_node_count; ++i)
+    {
+        const frozen_node_t& node = block.m_nodes[i];
+        const auto type = static_cast<value_type_t>(node.m_type);
+        const auto run = [&](std::uint64_t nodes)
+        {
+            return node.m_offset > i && node.m_offset <= header.m_node_count
+                   && nodes <= header.m_node_count - node.m_offset;
+        };
+        bool valid = true;
+        switch (type)
+        {
+            case value_type_t::nil:
+            case value_type_t::integer:
+            case value_type_t::floating_point:
+            case value_type_t::boolean:
+            case value_type_t::character: break;
+            case value_type_t::string:
+            case value_type_t::symbol:
+            case value_type_t::keyword:
+                valid = node.m_offset <= header.m_string_bytes && node.m_count <= header.m_string_bytes - node.m_offset;
+                break;
+            case value_type_t::vector:
+            case value_type_t::list:
+            case value_type_t::set:
+            case value_type_t::sorted_set: valid = run(node.m_count); break;
+            case value_type_t::map:
+            case value_type_t::sorted_map: valid = run(2 * std::uint64_t{ node.m_count }); break;
+            case value_type_t::tagged_element:
+                valid = node.m_count == 2 && run(2)
+                        && static_cast<value_type_t>(block.m_nodes[node.m_offset].m_type) == value_type_t::symbol;
+                break;
+            case value_type_t::quoted_element: valid = node.m_count == 1 && run(1); break;
+            default: valid = false; break;
+        }
+        if (!valid)
+        {
+            throw std::runtime_error{ str("frozen: invalid node ", i, " (", type, ")") };
+        }
+    }
+    return block;
+}
+
+}  // namespace detail
+
+// A value tree relocated into a single block: fixed-size nodes laid out in pre-order with the elements of every
+// collection adjacent, followed by a pool in which equal strings, symbols and keywords are stored once. The block
+// has no slack and no pointers, so it can be copied byte for byte (see data() and frozen_root()).
+class frozen_t
+{
+public:
+    explicit frozen_t(std::vector<std::uint64_t> block) : m_block(std::move(block))
+    {
+        detail::validate_frozen(m_block.data(), size());
+    }
+
+    frozen_value_t root() const
+    {
+        const char* const bytes = reinterpret_cast<const char*>(m_block.data());
+        const detail::frozen_header_t* const header = reinterpret_cast<const detail::frozen_header_t*>(bytes);
+        const auto* const nodes = reinterpret_cast<const detail::frozen_node_t*>(bytes + sizeof(*header));
+        return frozen_value_t{ { nodes, reinterpret_cast<const char*>(nodes + header->m_node_count) }, nodes };
+    }
+
+    const void* data() const { return m_block.data(); }
+
+    std::size_t size() const { return m_block.size() * sizeof(std::uint64_t); }
+
+private:
+    std::vector<std::uint64_t> m_block;
+};
+
+// Relocates `value` into a frozen block. Callables, atoms and futures cannot be frozen.
+inline frozen_t freeze(const value_t& value)
+{
+    return frozen_t{ detail::freezer_t{}.run(value) };
+}
+
+// View of the root of a frozen block stored elsewhere (a copy of frozen_t::data(), a mapped file); the block is
+// validated first and must stay alive and unchanged while the view is used.
+inline frozen_value_t frozen_root(const void* data, std::size_t size)
+{
+    const detail::frozen_block_t block = detail::validate_frozen(data, size);
+    return frozen_value_t{ block, block.m_nodes };
+}
+
+}  // namespace edn
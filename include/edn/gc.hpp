@@ -0,0 +1,312 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace edn
+{
+
+struct gc_statistics
+{
+    std::size_t collections = 0;
+    std::size_t live_cells = 0;
+    std::size_t reclaimed_cells = 0;
+    std::chrono::nanoseconds last_pause = {};
+    std::chrono::nanoseconds max_pause = {};
+    std::chrono::nanoseconds total_pause = {};
+};
+
+namespace detail
+{
+
+// Calls `func` with every atom_t and future_t reachable from `value` without passing through another reference cell.
+template <class Func>
+void for_each_reference(const value_t& value, Func&& func)
+{
+    if (const auto maybe_atom = value.if_atom())
+    {
+        func(*maybe_atom);
+    }
+    else if (const auto maybe_future = value.if_future())
+    {
+        func(*maybe_future);
+    }
+    else if (const auto maybe_vector = value.if_vector())
+    {
+        for (const value_t& item : *maybe_vector)
+        {
+            for_each_reference(item, func);
+        }
+    }
+    else if (const auto maybe_list = value.if_list())
+    {
+        for (const value_t& item : *maybe_list)
+        {
+            for_each_reference(item, func);
+        }
+    }
+    else if (const auto maybe_set = value.if_set())
+    {
+        for (const value_t& item : *maybe_set)
+        {
+            for_each_reference(item, func);
+        }
+    }
+    else if (const auto maybe_map = value.if_map())
+    {
+        for (const auto& [key, item] : *maybe_map)
+        {
+            for_each_reference(key, func);
+            for_each_reference(item, func);
+        }
+    }
+    else if (const auto maybe_sorted_set = value.if_sorted_set())
+    {
+        for (const value_t& item : *maybe_sorted_set)
+        {
+            for_each_reference(item, func);
+        }
+    }
+    else if (const auto maybe_sorted_map = value.if_sorted_map())
+    {
+        for (const auto& [key, item] : *maybe_sorted_map)
+        {
+            for_each_reference(key, func);
+            for_each_reference(item, func);
+        }
+    }
+    else if (const auto maybe_tagged_element = value.if_tagged_element())
+    {
+        for_each_reference(maybe_tagged_element->element(), func);
+    }
+    else if (const auto maybe_quoted_element = value.if_quoted_element())
+    {
+        for_each_reference(maybe_quoted_element->element(), func);
+    }
+}
+
+}  // namespace detail
+
+// Optional mark-sweep collector for the reference cells (atoms, futures) created by the evaluator. Plain values own
+// their children and never form cycles, but a cell may end up holding a value that refers back to itself, which
+// reference counting alone never frees. The heap keeps weak handles to every tracked cell; a collection marks the
+// cells reachable from the given roots, and from cells that are referenced from outside the heap (host variables,
+// in-flight evaluations), then clears the contents of the remaining ones so that their cycles fall apart.
+//
+// A collection inspects reference counts, so it has to run at a point where no other thread is updating the cells
+// tracked by this heap.
+class gc_heap
+{
+public:
+    explicit gc_heap(std::size_t collection_interval = 1024) : m_collection_interval{ collection_interval } { }
+
+    gc_heap(const gc_heap&) = delete;
+    gc_heap& operator=(const gc_heap&) = delete;
+
+    atom_t track(atom_t atom)
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_atoms.push_back(atom.m_state);
+        ++m_allocations;
+        return atom;
+    }
+
+    future_t track(future_t future)
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        m_futures.push_back(future.m_state);
+        ++m_allocations;
+        return future;
+    }
+
+    // True once `collection_interval` cells have been tracked since the previous collection.
+    bool collection_due() const
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        return m_collection_interval != 0 && m_allocations >= m_collection_interval;
+    }
+
+    // `roots` is any object exposing `for_each_value(func)`, such as `stack_t`.
+    template <class Roots>
+    std::size_t collect(const Roots& roots)
+    {
+        std::vector<const value_t*> root_values;
+        roots.for_each_value([&](const value_t& v) { root_values.push_back(&v); });
+        return collect_from(root_values);
+    }
+
+    std::size_t collect() { return collect_from({}); }
+
+    gc_statistics statistics() const
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        return m_statistics;
+    }
+
+private:
+    struct cell_t
+    {
+        std::shared_ptr<atom_t::state_t> m_atom;
+        std::shared_ptr<future_t::state_t> m_future;
+
+        const void* key() const { return m_atom ? static_cast<const void*>(m_atom.get()) : m_future.get(); }
+
+        long use_count() const { return m_atom ? m_atom.use_count() : m_future.use_count(); }
+
+        template <class Func>
+        void trace(Func&& func) const
+        {
+            if (m_atom)
+            {
+                const atom_t::pointer content = std::atomic_load(&m_atom->m_value);
+                detail::for_each_reference(*content, func);
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock{ m_future->m_mutex };
+                if (m_future->m_value)
+                {
+                    detail::for_each_reference(*m_future->m_value, func);
+                }
+            }
+        }
+
+        // Drops the content and returns it so that it is destroyed outside of any cell lock.
+        value_t clear() const
+        {
+            if (m_atom)
+            {
+                const atom_t::pointer content
+                    = std::atomic_exchange(&m_atom->m_value, std::make_shared<const value_t>(value_t{}));
+                return *content;
+            }
+            std::lock_guard<std::mutex> lock{ m_future->m_mutex };
+            value_t content = {};
+            if (m_future->m_value)
+            {
+                std::swap(content, *m_future->m_value);
+            }
+            return content;
+        }
+    };
+
+    static const void* key_of(const atom_t& atom) { return atom.m_state.get(); }
+    static const void* key_of(const future_t& future) { return future.m_state.get(); }
+
+    std::vector<cell_t> lock_cells()
+    {
+        std::vector<cell_t> cells;
+        cells.reserve(m_atoms.size() + m_futures.size());
+        const auto lock_all = [&](auto& weak_cells, auto member)
+        {
+            auto out = weak_cells.begin();
+            for (auto& weak : weak_cells)
+            {
+                if (auto cell = weak.lock())
+                {
+                    cell_t entry = {};
+                    entry.*member = std::move(cell);
+                    cells.push_back(std::move(entry));
+                    *out++ = std::move(weak);
+                }
+            }
+            weak_cells.erase(out, weak_cells.end());
+        };
+        lock_all(m_atoms, &cell_t::m_atom);
+        lock_all(m_futures, &cell_t::m_future);
+        return cells;
+    }
+
+    std::size_t collect_from(const std::vector<const value_t*>& roots)
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<cell_t> cells = lock_cells();
+        std::unordered_map<const void*, std::size_t> index;
+        index.reserve(cells.size());
+        for (std::size_t i = 0; i < cells.size(); ++i)
+        {
+            index.emplace(cells[i].key(), i);
+        }
+
+        // References held by other tracked cells; anything beyond those (and the handle locked above) comes from
+        // outside the heap and makes the cell a root.
+        std::vector<long> internal(cells.size(), 0);
+        for (const cell_t& cell : cells)
+        {
+            cell.trace(
+                [&](const auto& ref)
+                {
+                    if (const auto it = index.find(key_of(ref)); it != index.end())
+                    {
+                        ++internal[it->second];
+                    }
+                });
+        }
+
+        std::vector<bool> marked(cells.size(), false);
+        std::vector<std::size_t> pending;
+        const auto mark = [&](const auto& ref)
+        {
+            if (const auto it = index.find(key_of(ref)); it != index.end() && !marked[it->second])
+            {
+                marked[it->second] = true;
+                pending.push_back(it->second);
+            }
+        };
+        for (const value_t* root : roots)
+        {
+            detail::for_each_reference(*root, mark);
+        }
+        for (std::size_t i = 0; i < cells.size(); ++i)
+        {
+            if (!marked[i] && cells[i].use_count() - 1 > internal[i])
+            {
+                marked[i] = true;
+                pending.push_back(i);
+            }
+        }
+        while (!pending.empty())
+        {
+            const std::size_t i = pending.back();
+            pending.pop_back();
+            cells[i].trace(mark);
+        }
+
+        std::vector<value_t> garbage;
+        for (std::size_t i = 0; i < cells.size(); ++i)
+        {
+            if (!marked[i])
+            {
+                garbage.push_back(cells[i].clear());
+            }
+        }
+        const std::size_t reclaimed = garbage.size();
+        garbage.clear();
+        cells.clear();
+
+        const auto pause = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        m_allocations = 0;
+        m_statistics.collections += 1;
+        m_statistics.live_cells = index.size() - reclaimed;
+        m_statistics.reclaimed_cells += reclaimed;
+        m_statistics.last_pause = pause;
+        m_statistics.max_pause = std::max(m_statistics.max_pause, pause);
+        m_statistics.total_pause += pause;
+        return reclaimed;
+    }
+
+    mutable std::mutex m_mutex;
+    std::vector<std::weak_ptr<atom_t::state_t>> m_atoms;
+    std::vector<std::weak_ptr<future_t::state_t>> m_futures;
+    std::size_t m_collection_interval;
+    std::size_t m_allocations = 0;
+    gc_statistics m_statistics;
+};
+
+}  // namespace edn
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <algorithm>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace edn
+{
+
+// Top-level forms of a source text with their spans, kept by editors between edits.
+struct parsed_source_t
+{
+    std::vector<value_t> m_forms;
+    std::vector<span_t> m_spans;
+};
+
+// Replacement of `m_removed` bytes at `m_offset` by `m_inserted` bytes.
+struct text_edit_t
+{
+    std::size_t m_offset;
+    std::size_t m_removed;
+    std::size_t m_inserted;
+};
+
+namespace detail
+{
+
+inline location_t location_at(std::string_view text, std::size_t position)
+{
+    const std::string_view prefix = text.substr(0, position);
+    const std::size_t last_newline = prefix.rfind('\n');
+    return location_t{ static_cast<std::size_t>(std::count(prefix.begin(), prefix.end(), '\n')),
+                       last_newline == std::string_view::npos ? position : position - last_newline - 1 };
+}
+
+// Parses `text[begin, end)` with spans relative to `text`. Positions are only computed for error reporting, by
+// parsing again once a region has turned out to be invalid.
+inline parsed_source_t parse_region(std::string_view text, std::size_t begin, std::size_t end)
+{
+    const auto read = [&](location_t start)
+    {
+        stream_t stream{ text.substr(begin, end - begin), start };
+        parsed_source_t result = {};
+        parser_t parser{ stream, result.m_spans };
+        while (true)
+        {
+            stream.skip_whitespace_and_comments();
+            if (stream.eof())
+            {
+                break;
+            }
+            result.m_forms.push_back(parser.parse_value());
+        }
+        for (span_t& span : result.m_spans)
+        {
+            span.m_begin += begin;
+            span.m_end += begin;
+        }
+        return result;
+    };
+    try
+    {
+        return read(location_t{ 0, 0 });
+    }
+    catch (const parse_error&)
+    {
+        if (begin == 0)
+        {
+            throw;
+        }
+    }
+    return read(location_at(text, begin));
+}
+
+inline std::ptrdiff_t size_delta(const text_edit_t& edit)
+{
+    return static_cast<std::ptrdiff_t>(edit.m_inserted) - static_cast<std::ptrdiff_t>(edit.m_removed);
+}
+
+inline std::size_t offset(std::size_t position, std::ptrdiff_t delta)
+{
+    return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(position) + delta);
+}
+
+inline void shift(span_t& span, std::ptrdiff_t delta)
+{
+    span.m_begin = offset(span.m_begin, delta);
+    span.m_end = offset(span.m_end, delta);
+}
+
+// A node on the way from a top-level form to the edit: the value, its span and its absolute begin in the old text.
+struct reparse_frame_t
+{
+    value_t* m_value;
+    span_t* m_span;
+    std::size_t m_begin;
+};
+
+// Child of `value` (in source order) that can be replaced in place: elements of vectors and lists, values of maps.
+inline value_t* replaceable_child(value_t& value, const span_t& span, std::size_t index)
+{
+    const std::size_t count = span.m_children.size();
+    if (vector_t* maybe_vector = value.if_mutable<vector_t>(); maybe_vector && maybe_vector->size() == count)
+    {
+        return &(*maybe_vector)[index];
+    }
+    if (list_t* maybe_list = value.if_mutable<list_t>(); maybe_list && maybe_list->size() == count)
+    {
+        return &(*maybe_list)[index];
+    }
+    if (map_t* maybe_map = value.if_mutable<map_t>();
+        maybe_map && maybe_map->size() * 2 == count && index % 2 == 1)
+    {
+        return &maybe_map->m_items[index / 2].second;
+    }
+    return nullptr;
+}
+
+// Reparses the innermost value that encloses the edit without touching its first or last character. Returns the
+// reparsed range of the new text, or nothing if the edit has to be handled at the top level.
+inline std::optional<span_t> reparse_nested(parsed_source_t& source, std::string_view text, const text_edit_t& edit)
+{
+    const auto encloses = [&](std::size_t begin, std::size_t end)
+    { return begin < edit.m_offset && edit.m_offset + edit.m_removed < end; };
+    const auto form = std::find_if(
+        source.m_spans.begin(),
+        source.m_spans.end(),
+        [&](const span_t& span) { return encloses(span.m_begin, span.m_end); });
+    if (form == source.m_spans.end())
+    {
+        return std::nullopt;
+    }
+
+    std::vector<reparse_frame_t> path = {
+        { &source.m_forms[static_cast<std::size_t>(form - source.m_spans.begin())], &*form, form->m_begin }
+    };
+    while (true)
+    {
+        const reparse_frame_t& frame = path.back();
+        const auto child = std::find_if(
+            frame.m_span->m_children.begin(),
+            frame.m_span->m_children.end(),
+            [&](const span_t& span) { return encloses(frame.m_begin + span.m_begin, frame.m_begin + span.m_end); });
+        if (child == frame.m_span->m_children.end())
+        {
+            break;
+        }
+        const std::size_t index = static_cast<std::size_t>(child - frame.m_span->m_children.begin());
+        value_t* const value = replaceable_child(*frame.m_value, *frame.m_span, index);
+        if (!value)
+        {
+            break;
+        }
+        path.push_back({ value, &*child, frame.m_begin + child->m_begin });
+    }
+
+    const std::ptrdiff_t delta = size_delta(edit);
+    for (std::size_t depth = path.size(); depth-- > 0;)
+    {
+        const reparse_frame_t& frame = path[depth];
+        const std::size_t begin = frame.m_begin;
+        const std::size_t end = offset(begin + frame.m_span->size(), delta);
+        parsed_source_t region = {};
+        try
+        {
+            region = parse_region(text, begin, end);
+        }
+        catch (const parse_error&)
+        {
+            continue;
+        }
+        if (region.m_forms.size() != 1 || region.m_spans[0].m_begin != begin || region.m_spans[0].m_end != end)
+        {
+            continue;
+        }
+
+        *frame.m_value = std::move(region.m_forms[0]);
+        span_t& span = *frame.m_span;
+        const std::size_t relative_begin = span.m_begin;
+        span = std::move(region.m_spans[0]);
+        span.m_begin = relative_begin;
+        span.m_end = relative_begin + (end - begin);
+        // Enclosing spans grow or shrink by `delta`, the siblings after them move by `delta`.
+        for (std::size_t i = depth; i-- > 0;)
+        {
+            span_t& parent = *path[i].m_span;
+            parent.m_end = offset(parent.m_end, delta);
+            const std::ptrdiff_t index = path[i + 1].m_span - parent.m_children.data();
+            std::for_each(
+                parent.m_children.begin() + index + 1, parent.m_children.end(), [&](span_t& s) { shift(s, delta); });
+        }
+        std::for_each(form + 1, source.m_spans.end(), [&](span_t& s) { shift(s, delta); });
+        return span_t{ begin, end };
+    }
+    return std::nullopt;
+}
+
+// Reparses the top-level forms touched by the edit, from the end of the preceding form to the end of the line that
+// holds the following one (so that a new comment cannot reach past the region). If that region does not parse on its
+// own, everything up to the end of the text is reparsed.
+inline span_t reparse_top_level(parsed_source_t& source, std::string_view text, const text_edit_t& edit)
+{
+    const std::ptrdiff_t delta = size_delta(edit);
+    const std::vector<span_t>& spans = source.m_spans;
+    const auto first = static_cast<std::size_t>(
+        std::find_if(spans.begin(), spans.end(), [&](const span_t& span) { return span.m_end >= edit.m_offset; })
+        - spans.begin());
+    std::size_t last = first;
+    while (last < spans.size() && spans[last].m_begin <= edit.m_offset + edit.m_removed)
+    {
+        ++last;
+    }
+    // Forms [first, last) overlap or touch the edit; the one after them is reparsed as well.
+    const std::size_t begin = first > 0 ? spans[first - 1].m_end : 0;
+    std::size_t end = text.size();
+    if (last < spans.size())
+    {
+        end = std::min(text.find('\n', offset(spans[last].m_end, delta)), end);
+    }
+    std::size_t stop = last;
+    while (stop < spans.size() && offset(spans[stop].m_begin, delta) < end)
+    {
+        ++stop;
+    }
+
+    parsed_source_t region = {};
+    try
+    {
+        region = parse_region(text, begin, end);
+    }
+    catch (const parse_error&)
+    {
+        if (end == text.size())
+        {
+            throw;
+        }
+        end = text.size();
+        stop = spans.size();
+        region = parse_region(text, begin, end);
+    }
+
+    std::for_each(
+        source.m_spans.begin() + static_cast<std::ptrdiff_t>(stop),
+        source.m_spans.end(),
+        [&](span_t& span) { shift(span, delta); });
+    const auto replace = [&](auto& items, auto& replacement)
+    {
+        items.erase(items.begin() + static_cast<std::ptrdiff_t>(first), items.begin() + static_cast<std::ptrdiff_t>(stop));
+        items.insert(
+            items.begin() + static_cast<std::ptrdiff_t>(first),
+            std::make_move_iterator(replacement.begin()),
+            std::make_move_iterator(replacement.end()));
+    };
+    replace(source.m_forms, region.m_forms);
+    replace(source.m_spans, region.m_spans);
+    return span_t{ begin, end };
+}
+
+}  // namespace detail
+
+inline parsed_source_t parse_with_spans(std::string_view text)
+{
+    return detail::parse_region(text, 0, text.size());
+}
+
+// Brings `source`, parsed from the text before `edit`, up to date with `text`, the text after it. Only the innermost
+// vector, list or map value enclosing the edit is reparsed when possible, otherwise the touched top-level forms;
+// everything else, values and spans alike, is kept. Returns the reparsed range of `text`. On a parse error `source`
+// is left unchanged.
+inline span_t reparse(parsed_source_t& source, std::string_view text, const text_edit_t& edit)
+{
+    if (auto nested = detail::reparse_nested(source, text, edit))
+    {
+        return std::move(*nested);
+    }
+    return detail::reparse_top_level(source, text, edit);
+}
+
+}  // namespace edn
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <edn/thread_pool.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define EDN_HAS_IO_URING 1
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#else
+#define EDN_HAS_IO_URING 0
+#endif
+
+namespace edn
+{
+
+struct ingest_options_t
+{
+    // Files read or parsed at the same time; bounds the memory held by file buffers.
+    std::size_t max_in_flight = 64;
+    // Parser workers; the default pool if null. ingest() must not be called from one of its workers.
+    thread_pool* pool = nullptr;
+    // Reads through io_uring where the kernel supports it, with blocking reads on the pool otherwise.
+    bool use_io_uring = true;
+    // Called on a worker thread for each file that cannot be read or parsed.
+    std::function<void(const std::filesystem::path& path, const std::exception& error)> on_error = {};
+};
+
+struct ingest_statistics_t
+{
+    std::size_t files = 0;
+    std::size_t failed = 0;
+    std::size_t bytes = 0;
+    bool io_uring = false;
+};
+
+using ingest_callback_t = std::function<void(const std::filesystem::path& path, value_t value)>;
+
+namespace detail
+{
+
+// Parsing and completion bookkeeping shared by both readers. A permit is taken before a file is read and returned
+// once it has been parsed, so at most `max_in_flight` buffers exist at any time.
+class ingest_state_t
+{
+public:
+    ingest_state_t(const std::vector<std::filesystem::path>& paths, ingest_callback_t callback, ingest_options_t options)
+        : m_paths(paths)
+        , m_callback(std::move(callback))
+        , m_options(std::move(options))
+        , m_pool(m_options.pool ? *m_options.pool : thread_pool::default_pool())
+        , m_permits(std::max<std::size_t>(m_options.max_in_flight, 1))
+    {
+    }
+
+    const std::filesystem::path& path(std::size_t index) const { return m_paths[index]; }
+
+    thread_pool& pool() { return m_pool; }
+
+    bool try_acquire()
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        if (m_permits == 0)
+        {
+            return false;
+        }
+        --m_permits;
+        return true;
+    }
+
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_released.wait(lock, [this]() { return m_permits > 0; });
+        --m_permits;
+    }
+
+    void release()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            ++m_permits;
+        }
+        m_released.notify_all();
+    }
+
+    // Parses `text` and returns the permit.
+    void parse(std::size_t index, const std::string& text)
+    {
+        m_bytes += text.size();
+        try
+        {
+            value_t value = edn::parse(text);
+            ++m_files;
+            m_callback(path(index), std::move(value));
+        }
+        catch (const std::exception& error)
+        {
+            fail(index, error);
+        }
+        release();
+    }
+
+    void parse_async(std::size_t index, std::string text)
+    {
+        m_pool.submit([this, index, text = std::move(text)]() { parse(index, text); });
+    }
+
+    void fail(std::size_t index, const std::exception& error)
+    {
+        ++m_failed;
+        if (m_options.on_error)
+        {
+            m_options.on_error(path(index), error);
+        }
+    }
+
+    // Waits until every permit is back, i.e. every file has been parsed or has failed.
+    ingest_statistics_t finish(bool io_uring)
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_released.wait(lock, [this]() { return m_permits == std::max<std::size_t>(m_options.max_in_flight, 1); });
+        return ingest_statistics_t{ m_files, m_failed, m_bytes, io_uring };
+    }
+
+private:
+    const std::vector<std::filesystem::path>& m_paths;
+    ingest_callback_t m_callback;
+    ingest_options_t m_options;
+    thread_pool& m_pool;
+
+    std::mutex m_mutex;
+    std::condition_variable m_released;
+    std::size_t m_permits;
+
+    std::atomic<std::size_t> m_files = 0;
+    std::atomic<std::size_t> m_failed = 0;
+    std::atomic<std::size_t> m_bytes = 0;
+};
+
+inline std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    if (!file)
+    {
+        throw std::runtime_error{ str("ingest: cannot open '", path.string(), "'") };
+    }
+    return std::string(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+}
+
+inline void ingest_blocking(ingest_state_t& state, std::size_t count)
+{
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        state.acquire();
+        state.pool().submit(
+            [&state, index]()
+            {
+                std::string text;
+                try
+                {
+                    text = read_file(state.path(index));
+                }
+                catch (const std::exception& error)
+                {
+                    state.fail(index, error);
+                    state.release();
+                    return;
+                }
+                state.parse(index, text);
+            });
+    }
+}
+
+#if EDN_HAS_IO_URING
+
+// Minimal io_uring over the raw system calls: one submission queue of reads and its completion queue, used by a
+// single thread.
+class io_uring_t
+{
+public:
+    // Null if the kernel lacks io_uring or reads at explicit offsets (IORING_OP_READ, Linux 5.6), or forbids it.
+    static std::unique_ptr<io_uring_t> create(unsigned entries)
+    {
+        io_uring_params params = {};
+        const long fd = ::syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        std::unique_ptr<io_uring_t> ring{ new io_uring_t{ static_cast<int>(fd), params } };
+        if (!(params.features & IORING_FEAT_RW_CUR_POS) || !ring->map())
+        {
+            return nullptr;
+        }
+        return ring;
+    }
+
+    io_uring_t(const io_uring_t&) = delete;
+    io_uring_t& operator=(const io_uring_t&) = delete;
+
+    ~io_uring_t()
+    {
+        if (m_sqes != MAP_FAILED)
+        {
+            ::munmap(m_sqes, m_sqes_size);
+        }
+        if (m_cq != MAP_FAILED && m_cq != m_sq)
+        {
+            ::munmap(m_cq, m_cq_size);
+        }
+        if (m_sq != MAP_FAILED)
+        {
+            ::munmap(m_sq, m_sq_size);
+        }
+        ::close(m_fd);
+    }
+
+    unsigned capacity() const { return m_params.sq_entries; }
+
+    // Queues a read of `length` bytes at `offset` of `fd`. The caller keeps the reads in flight within capacity().
+    void read(int fd, char* buffer, std::size_t length, std::uint64_t offset, std::uint64_t user_data)
+    {
+        const unsigned tail = *field(m_sq, m_params.sq_off.tail);
+        const unsigned index = tail & *field(m_sq, m_params.sq_off.ring_mask);
+        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(m_sqes)[index];
+        sqe = io_uring_sqe{};
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(buffer));
+        sqe.len = static_cast<std::uint32_t>(std::min<std::size_t>(length, 1U << 30));
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        field(m_sq, m_params.sq_off.array)[index] = index;
+        __atomic_store_n(field(m_sq, m_params.sq_off.tail), tail + 1, __ATOMIC_RELEASE);
+        ++m_unsubmitted;
+    }
+
+    // Submits queued reads and waits for at least one completion.
+    void submit_and_wait()
+    {
+        while (true)
+        {
+            const long submitted
+                = ::syscall(__NR_io_uring_enter, m_fd, m_unsubmitted, 1U, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (submitted >= 0)
+            {
+                m_unsubmitted -= static_cast<unsigned>(submitted);
+                return;
+            }
+            if (errno != EINTR && errno != EAGAIN)
+            {
+                throw std::system_error{ errno, std::generic_category(), "io_uring_enter" };
+            }
+        }
+    }
+
+    // Calls `func(user_data, result)` for every completion available.
+    template <class Func>
+    void reap(Func&& func)
+    {
+        unsigned* const head_field = field(m_cq, m_params.cq_off.head);
+        const unsigned mask = *field(m_cq, m_params.cq_off.ring_mask);
+        unsigned head = *head_field;
+        const unsigned tail = __atomic_load_n(field(m_cq, m_params.cq_off.tail), __ATOMIC_ACQUIRE);
+        const io_uring_cqe* const cqes
+            = static_cast<const io_uring_cqe*>(static_cast<void*>(static_cast<char*>(m_cq) + m_params.cq_off.cqes));
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe cqe = cqes[head & mask];
+            __atomic_store_n(head_field, head + 1, __ATOMIC_RELEASE);
+            func(cqe.user_data, cqe.res);
+        }
+    }
+
+private:
+    int m_fd;
+    io_uring_params m_params;
+    void* m_sq = MAP_FAILED;
+    void* m_cq = MAP_FAILED;
+    void* m_sqes = MAP_FAILED;
+    std::size_t m_sq_size = 0;
+    std::size_t m_cq_size = 0;
+    std::size_t m_sqes_size = 0;
+    unsigned m_unsubmitted = 0;
+
+    io_uring_t(int fd, const io_uring_params& params) : m_fd(fd), m_params(params) { }
+
+    static unsigned* field(void* ring, std::uint32_t offset)
+    {
+        return static_cast<unsigned*>(static_cast<void*>(static_cast<char*>(ring) + offset));
+    }
+
+    bool map()
+    {
+        m_sq_size = m_params.sq_off.array + m_params.sq_entries * sizeof(unsigned);
+        m_cq_size = m_params.cq_off.cqes + m_params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (m_params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+        {
+            m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+        }
+        m_sq = ::mmap(nullptr, m_sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+        if (m_sq == MAP_FAILED)
+        {
+            return false;
+        }
+        m_cq = single
+                   ? m_sq
+                   : ::mmap(nullptr, m_cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+        m_sqes_size = m_params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+        return m_cq != MAP_FAILED && m_sqes != MAP_FAILED;
+    }
+};
+
+// Keeps up to `ring.capacity()` reads in flight, one per file, sized by the file size at open time; short reads are
+// resumed. Each completed buffer is handed to the parser pool while further reads proceed.
+inline void ingest_io_uring(ingest_state_t& state, std::size_t count, io_uring_t& ring)
+{
+    struct read_t
+    {
+        std::size_t m_index;
+        int m_fd;
+        std::string m_buffer;
+        std::size_t m_done;
+    };
+
+    std::vector<std::optional<read_t>> slots(ring.capacity());
+    std::vector<std::size_t> free_slots;
+    for (std::size_t i = slots.size(); i-- > 0;)
+    {
+        free_slots.push_back(i);
+    }
+
+    const auto fail = [&](std::size_t index, int error)
+    {
+        const std::string what = str("ingest: '", state.path(index).string(), "'");
+        state.fail(index, std::system_error{ error, std::generic_category(), what });
+        state.release();
+    };
+
+    const auto complete = [&](std::size_t slot)
+    {
+        read_t read = std::move(*slots[slot]);
+        slots[slot].reset();
+        free_slots.push_back(slot);
+        ::close(read.m_fd);
+        read.m_buffer.resize(read.m_done);
+        state.parse_async(read.m_index, std::move(read.m_buffer));
+    };
+
+    const auto start = [&](std::size_t index)
+    {
+        const int fd = ::open(state.path(index).c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info = {};
+        if (fd < 0 || ::fstat(fd, &info) != 0)
+        {
+            const int error = errno;
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+            fail(index, error);
+            return;
+        }
+        const std::size_t slot = free_slots.back();
+        free_slots.pop_back();
+        slots[slot] = read_t{ index, fd, std::string(static_cast<std::size_t>(info.st_size), '\0'), 0 };
+        if (info.st_size == 0)
+        {
+            complete(slot);
+            return;
+        }
+        ring.read(fd, slots[slot]->m_buffer.data(), slots[slot]->m_buffer.size(), 0, slot);
+    };
+
+    std::size_t next = 0;
+    while (true)
+    {
+        while (next < count && !free_slots.empty())
+        {
+            if (!state.try_acquire())
+            {
+                if (free_slots.size() != slots.size())
+                {
+                    break;
+                }
+                state.acquire();
+            }
+            start(next++);
+        }
+        if (free_slots.size() == slots.size())
+        {
+            if (next == count)
+            {
+                return;
+            }
+            continue;
+        }
+        ring.submit_and_wait();
+        ring.reap(
+            [&](std::uint64_t user_data, int result)
+            {
+                const auto slot = static_cast<std::size_t>(user_data);
+                read_t& read = *slots[slot];
+                if (result < 0)
+                {
+                    const std::size_t index = read.m_index;
+                    ::close(read.m_fd);
+                    slots[slot].reset();
+                    free_slots.push_back(slot);
+                    fail(index, -result);
+                    return;
+                }
+                read.m_done += static_cast<std::size_t>(result);
+                if (result == 0 || read.m_done == read.m_buffer.size())
+                {
+                    complete(slot);
+                    return;
+                }
+                ring.read(
+                    read.m_fd,
+                    read.m_buffer.data() + read.m_done,
+                    read.m_buffer.size() - read.m_done,
+                    read.m_done,
+                    slot);
+            });
+    }
+}
+
+#endif
+
+}  // namespace detail
+
+// Reads and parses `paths`, overlapping I/O with parsing: files are read up to `max_in_flight` at a time (through
+// io_uring on Linux, otherwise by blocking reads on the pool) and each buffer is parsed on the pool as soon as it is
+// complete. `callback` receives every parsed value, concurrently from the pool's workers and in no particular order.
+// Returns once every file has been handled.
+inline ingest_statistics_t ingest(
+    const std::vector<std::filesystem::path>& paths, ingest_callback_t callback, ingest_options_t options = {})
+{
+    const bool use_io_uring = options.use_io_uring;
+    const std::size_t max_in_flight = std::max<std::size_t>(options.max_in_flight, 1);
+    detail::ingest_state_t state{ paths, std::move(callback), std::move(options) };
+#if EDN_HAS_IO_URING
+    if (use_io_uring)
+    {
+        const auto entries = static_cast<unsigned>(std::min<std::size_t>(max_in_flight, 4096));
+        if (const auto ring = detail::io_uring_t::create(entries))
+        {
+            detail::ingest_io_uring(state, paths.size(), *ring);
+            return state.finish(true);
+        }
+    }
+#else
+    (void)use_io_uring;
+    (void)max_in_flight;
+#endif
+    detail::ingest_blocking(state, paths.size());
+    return state.finish(false);
+}
+
+}  // namespace edn
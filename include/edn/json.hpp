@@ -0,0 +1,642 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace edn
+{
+
+// How JSON object keys are read.
+enum class json_keys_t
+{
+    keyword,  // {"id": 1} -> {:id 1}
+    string    // {"id": 1} -> {"id" 1}
+};
+
+struct json_read_options_t
+{
+    json_keys_t keys = json_keys_t::keyword;
+    // Nesting deeper than this is rejected instead of exhausting the stack.
+    std::size_t max_depth = 512;
+};
+
+namespace detail
+{
+
+// Thrown by a json_parser_t that ran out of text while more of it may still arrive.
+struct json_incomplete_t
+{
+};
+
+// Recursive descent JSON parser producing values directly. Objects become maps (in source order, the last of repeated
+// keys wins), arrays vectors; integers that do not fit integer_t become doubles. Lines and columns are only counted
+// when an error is reported.
+class json_parser_t
+{
+public:
+    // `final` tells whether `text` is all there is; if not, running into its end throws json_incomplete_t.
+    json_parser_t(std::string_view text, const json_read_options_t& options, bool final)
+        : m_text(text)
+        , m_options(options)
+        , m_final(final)
+    {
+    }
+
+    value_t parse_value(std::size_t depth = 0)
+    {
+        skip_whitespace();
+        switch (peek())
+        {
+            case '{': return parse_object(depth);
+            case '[': return parse_array(depth);
+            case '"': return parse_string();
+            case 't': return parse_literal("true", true);
+            case 'f': return parse_literal("false", false);
+            case 'n': return parse_literal("null", nil);
+            default:
+                if (peek() == '-' || (peek() >= '0' && peek() <= '9'))
+                {
+                    return parse_number();
+                }
+                fail(str("Unexpected character '", peek(), "'"));
+        }
+    }
+
+    void skip_whitespace()
+    {
+        while (m_pos < m_text.size()
+               && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\t' || m_text[m_pos] == '\r'))
+        {
+            ++m_pos;
+        }
+    }
+
+    bool eof() const { return m_pos == m_text.size(); }
+
+    std::size_t position() const { return m_pos; }
+
+    [[noreturn]] void fail(const std::string& message) const
+    {
+        location_t location = { 0, 0 };
+        for (std::size_t i = 0; i < m_pos && i < m_text.size(); ++i)
+        {
+            location = m_text[i] == '\n' ? location_t{ location.line + 1, 0 }
+                                         : location_t{ location.line, location.column + 1 };
+        }
+        throw parse_error{ message, location };
+    }
+
+private:
+    std::string_view m_text;
+    const json_read_options_t& m_options;
+    bool m_final;
+    std::size_t m_pos = 0;
+
+    char peek()
+    {
+        if (eof())
+        {
+            if (!m_final)
+            {
+                throw json_incomplete_t{};
+            }
+            fail("Unexpected end of input");
+        }
+        return m_text[m_pos];
+    }
+
+    void expect(char c)
+    {
+        if (peek() != c)
+        {
+            fail(str("Expected '", c, "'"));
+        }
+        ++m_pos;
+    }
+
+    value_t parse_literal(std::string_view word, value_t result)
+    {
+        for (const char c : word)
+        {
+            expect(c);
+        }
+        return result;
+    }
+
+    value_t parse_number()
+    {
+        const std::size_t start = m_pos;
+        bool integral = true;
+        while (m_pos < m_text.size())
+        {
+            const char c = m_text[m_pos];
+            if (c == '.' || c == 'e' || c == 'E')
+            {
+                integral = false;
+            }
+            else if (!(c >= '0' && c <= '9') && c != '-' && c != '+')
+            {
+                break;
+            }
+            ++m_pos;
+        }
+        if (eof() && !m_final)
+        {
+            throw json_incomplete_t{};  // the number may go on
+        }
+        const char* const first = m_text.data() + start;
+        const char* const last = m_text.data() + m_pos;
+        if (integral)
+        {
+            integer_t result = 0;
+            const auto [end, error] = std::from_chars(first, last, result);
+            if (error == std::errc{} && end == last)
+            {
+                return result;
+            }
+        }
+        double result = 0;
+        const auto [end, error] = std::from_chars(first, last, result);
+        if (error != std::errc{} || end != last)
+        {
+            m_pos = start;
+            fail(str("Invalid number '", std::string_view{ first, static_cast<std::size_t>(last - first) }, "'"));
+        }
+        return result;
+    }
+
+    unsigned parse_hex4()
+    {
+        unsigned result = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const char c = peek();
+            ++m_pos;
+            result <<= 4;
+            if (c >= '0' && c <= '9')
+            {
+                result |= static_cast<unsigned>(c - '0');
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                result |= static_cast<unsigned>(c - 'a' + 10);
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                result |= static_cast<unsigned>(c - 'A' + 10);
+            }
+            else
+            {
+                fail("Invalid \\u escape");
+            }
+        }
+        return result;
+    }
+
+    static void append_utf8(std::string& out, unsigned code_point)
+    {
+        if (code_point < 0x80)
+        {
+            out += static_cast<char>(code_point);
+        }
+        else if (code_point < 0x800)
+        {
+            out += static_cast<char>(0xc0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+        else if (code_point < 0x10000)
+        {
+            out += static_cast<char>(0xe0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+        else
+        {
+            out += static_cast<char>(0xf0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+    }
+
+    std::string read_string()
+    {
+        expect('"');
+        std::string result;
+        while (true)
+        {
+            // Copy the run up to the next quote, backslash or control character in one go.
+            const std::size_t start = m_pos;
+            while (m_pos < m_text.size() && m_text[m_pos] != '"' && m_text[m_pos] != '\\'
+                   && static_cast<unsigned char>(m_text[m_pos]) >= 0x20)
+            {
+                ++m_pos;
+            }
+            result.append(m_text.data() + start, m_pos - start);
+            const char c = peek();
+            ++m_pos;
+            if (c == '"')
+            {
+                return result;
+            }
+            if (c != '\\')
+            {
+                --m_pos;
+                fail("Control character in string");
+            }
+            const char escape = peek();
+            ++m_pos;
+            switch (escape)
+            {
+                case '"': result += '"'; break;
+                case '\\': result += '\\'; break;
+                case '/': result += '/'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u':
+                {
+                    unsigned code_point = parse_hex4();
+                    if (code_point >= 0xd800 && code_point < 0xdc00)
+                    {
+                        expect('\\');
+                        expect('u');
+                        const unsigned low = parse_hex4();
+                        if (low < 0xdc00 || low >= 0xe000)
+                        {
+                            fail("Invalid surrogate pair");
+                        }
+                        code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    append_utf8(result, code_point);
+                    break;
+                }
+                default: --m_pos; fail(str("Invalid escape sequence: \\", escape));
+            }
+        }
+    }
+
+    value_t parse_string() { return read_string(); }
+
+    void enter(std::size_t depth)
+    {
+        if (depth >= m_options.max_depth)
+        {
+            fail("Nesting too deep");
+        }
+        ++m_pos;
+        skip_whitespace();
+    }
+
+    value_t parse_array(std::size_t depth)
+    {
+        enter(depth);
+        vector_t result;
+        if (peek() == ']')
+        {
+            ++m_pos;
+            return result;
+        }
+        while (true)
+        {
+            result.push_back(parse_value(depth + 1));
+            skip_whitespace();
+            if (peek() == ']')
+            {
+                ++m_pos;
+                return result;
+            }
+            expect(',');
+        }
+    }
+
+    // Small objects are deduplicated by linear search, which beats map_builder's sort for a handful of keys.
+    static value_t make_map(std::vector<map_t::value_type> items)
+    {
+        if (items.size() > 16)
+        {
+            map_builder builder{ items.size() };
+            for (map_t::value_type& item : items)
+            {
+                builder.insert(std::move(item.first), std::move(item.second));
+            }
+            return std::move(builder).build();
+        }
+        map_t result;
+        result.m_items.reserve(items.size());
+        for (map_t::value_type& item : items)
+        {
+            if (const auto it = result.find(item.first); it != result.end())
+            {
+                it->second = std::move(item.second);
+            }
+            else
+            {
+                result.m_items.push_back(std::move(item));
+            }
+        }
+        return result;
+    }
+
+    value_t make_key(std::string key) const
+    {
+        if (m_options.keys == json_keys_t::string)
+        {
+            return key;
+        }
+        keyword_t keyword;
+        static_cast<std::string&>(keyword) = std::move(key);
+        return keyword;
+    }
+
+    value_t parse_object(std::size_t depth)
+    {
+        enter(depth);
+        std::vector<map_t::value_type> items;
+        if (peek() == '}')
+        {
+            ++m_pos;
+            return map_t{};
+        }
+        while (true)
+        {
+            skip_whitespace();
+            value_t key = make_key(read_string());
+            skip_whitespace();
+            expect(':');
+            value_t value = parse_value(depth + 1);
+            items.emplace_back(std::move(key), std::move(value));
+            skip_whitespace();
+            if (peek() == '}')
+            {
+                ++m_pos;
+                return make_map(std::move(items));
+            }
+            expect(',');
+        }
+    }
+};
+
+// Appends JSON text to a string; numbers go through to_chars (shortest round-trip form for doubles).
+class json_writer_t
+{
+public:
+    explicit json_writer_t(std::string& out) : m_out(out) { }
+
+    void write(const value_t& item)
+    {
+        switch (item.type())
+        {
+            case value_type_t::nil: m_out += "null"; return;
+            case value_type_t::boolean: m_out += *item.if_boolean() ? "true" : "false"; return;
+            case value_type_t::integer: write_number(*item.if_integer()); return;
+            case value_type_t::floating_point: write_double(*item.if_floating_point()); return;
+            case value_type_t::character: write_string(std::string_view{ item.if_character(), 1 }); return;
+            case value_type_t::string: write_string(*item.if_string()); return;
+            case value_type_t::symbol: write_string(*item.if_symbol()); return;
+            case value_type_t::keyword: write_string(*item.if_keyword()); return;
+            case value_type_t::vector: write_array(*item.if_vector()); return;
+            case value_type_t::list: write_array(*item.if_list()); return;
+            case value_type_t::set: write_array(*item.if_set()); return;
+            case value_type_t::sorted_set: write_array(*item.if_sorted_set()); return;
+            case value_type_t::map: write_object(*item.if_map()); return;
+            case value_type_t::sorted_map: write_object(*item.if_sorted_map()); return;
+            // JSON has no tags or quoting; the element stands for itself.
+            case value_type_t::tagged_element: write(item.if_tagged_element()->element()); return;
+            case value_type_t::quoted_element: write(item.if_quoted_element()->element()); return;
+            default: throw std::runtime_error{ str("json: cannot write ", item.type()) };
+        }
+    }
+
+private:
+    std::string& m_out;
+
+    template <class T>
+    void write_number(T number)
+    {
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        m_out.append(buffer, result.ptr);
+    }
+
+    void write_double(double number)
+    {
+        if (!std::isfinite(number))
+        {
+            throw std::runtime_error{ str("json: cannot write ", number) };
+        }
+        const std::size_t start = m_out.size();
+        write_number(number);
+        // Keep it a floating point number when read back.
+        if (m_out.find_first_of(".eE", start) == std::string::npos)
+        {
+            m_out += ".0";
+        }
+    }
+
+    void write_string(std::string_view text)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+        m_out += '"';
+        std::size_t run = 0;  // start of the pending run of characters that need no escaping
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            const auto c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                continue;
+            }
+            m_out.append(text.data() + run, i - run);
+            run = i + 1;
+            m_out += '\\';
+            switch (c)
+            {
+                case '"': m_out += '"'; break;
+                case '\\': m_out += '\\'; break;
+                case '\n': m_out += 'n'; break;
+                case '\r': m_out += 'r'; break;
+                case '\t': m_out += 't'; break;
+                case '\b': m_out += 'b'; break;
+                case '\f': m_out += 'f'; break;
+                default:
+                    m_out += "u00";
+                    m_out += hex[c >> 4];
+                    m_out += hex[c & 0xf];
+                    break;
+            }
+        }
+        m_out.append(text.data() + run, text.size() - run);
+        m_out += '"';
+    }
+
+    template <class Range>
+    void write_array(const Range& items)
+    {
+        m_out += '[';
+        bool first = true;
+        for (const value_t& item : items)
+        {
+            if (!std::exchange(first, false))
+            {
+                m_out += ',';
+            }
+            write(item);
+        }
+        m_out += ']';
+    }
+
+    // Object keys must be strings: strings, keywords and symbols give their text, other keys their EDN form.
+    void write_key(const value_t& key)
+    {
+        if (const auto string = key.if_string())
+        {
+            write_string(*string);
+        }
+        else if (const auto keyword = key.if_keyword())
+        {
+            write_string(*keyword);
+        }
+        else if (const auto symbol = key.if_symbol())
+        {
+            write_string(*symbol);
+        }
+        else
+        {
+            write_string(str(key));
+        }
+    }
+
+    template <class Range>
+    void write_object(const Range& items)
+    {
+        m_out += '{';
+        bool first = true;
+        for (const auto& [key, value] : items)
+        {
+            if (!std::exchange(first, false))
+            {
+                m_out += ',';
+            }
+            write_key(key);
+            m_out += ':';
+            write(value);
+        }
+        m_out += '}';
+    }
+};
+
+}  // namespace detail
+
+// Appends the JSON form of `item` to `out`. Keywords and symbols become strings, all collections but maps become
+// arrays, tags and quotes are dropped. Throws for values JSON cannot represent (functions, atoms, NaN, ...).
+inline void write_json(std::string& out, const value_t& item)
+{
+    detail::json_writer_t{ out }.write(item);
+}
+
+inline std::string to_json(const value_t& item)
+{
+    std::string result;
+    write_json(result, item);
+    return result;
+}
+
+inline void write_json(std::ostream& os, const value_t& item)
+{
+    os << to_json(item);
+}
+
+// Parses one JSON document; only whitespace may follow it.
+inline value_t parse_json(std::string_view text, const json_read_options_t& options = {})
+{
+    detail::json_parser_t parser{ text, options, true };
+    value_t result = parser.parse_value();
+    parser.skip_whitespace();
+    if (!parser.eof())
+    {
+        parser.fail("Unexpected text after JSON document");
+    }
+    return result;
+}
+
+// Reads a stream of JSON documents (JSON lines, or documents simply written one after another) one at a time,
+// holding only the unread part of the input in memory.
+class json_reader
+{
+public:
+    explicit json_reader(std::istream& is, json_read_options_t options = {}, std::size_t chunk_size = 64 * 1024)
+        : m_is(is)
+        , m_options(options)
+        , m_chunk_size(std::max<std::size_t>(chunk_size, 1))
+    {
+    }
+
+    // The next document, or nothing at the end of the stream.
+    std::optional<value_t> next()
+    {
+        std::size_t wanted = m_chunk_size;
+        while (true)
+        {
+            detail::json_parser_t parser{ std::string_view{ m_buffer }.substr(m_pos), m_options, m_eof };
+            parser.skip_whitespace();
+            if (parser.eof())
+            {
+                if (m_eof)
+                {
+                    return std::nullopt;
+                }
+                m_pos += parser.position();
+            }
+            else
+            {
+                try
+                {
+                    value_t result = parser.parse_value();
+                    m_pos += parser.position();
+                    return result;
+                }
+                catch (const detail::json_incomplete_t&)
+                {
+                    // The document continues past the buffer; read at least as much again as is buffered, so that a
+                    // large document is reparsed a logarithmic number of times.
+                    wanted = std::max(wanted, m_buffer.size() - m_pos);
+                }
+            }
+            fill(wanted);
+        }
+    }
+
+private:
+    std::istream& m_is;
+    json_read_options_t m_options;
+    std::size_t m_chunk_size;
+    std::string m_buffer;
+    std::size_t m_pos = 0;
+    bool m_eof = false;
+
+    void fill(std::size_t size)
+    {
+        m_buffer.erase(0, m_pos);
+        m_pos = 0;
+        const std::size_t old_size = m_buffer.size();
+        m_buffer.resize(old_size + size);
+        m_is.read(m_buffer.data() + old_size, static_cast<std::streamsize>(size));
+        const auto count = static_cast<std::size_t>(m_is.gcount());
+        m_buffer.resize(old_size + count);
+        m_eof = count < size;
+    }
+};
+
+}  // namespace edn
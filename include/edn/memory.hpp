@@ -0,0 +1,201 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <array>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace edn
+{
+
+// Memory attributed to the values of one type.
+//  - node_bytes: the value_t slots holding the values, wherever they live (in a parent's buffer, a box, the root);
+//  - string_bytes: heap buffers of strings, symbols, keywords and tags that do not fit the small string buffer;
+//  - slack_bytes: reserved but unused capacity of the collection buffers;
+//  - box_bytes: the heap allocation of each boxed collection and the bookkeeping of node-based containers (tree node
+//    headers and links).
+// Allocator headers and alignment padding are not included. Atoms and futures are counted by their shared state only:
+// their content is shared and not followed.
+struct memory_category_t
+{
+    std::size_t count = 0;
+    std::size_t node_bytes = 0;
+    std::size_t string_bytes = 0;
+    std::size_t slack_bytes = 0;
+    std::size_t box_bytes = 0;
+
+    std::size_t total() const { return node_bytes + string_bytes + slack_bytes + box_bytes; }
+
+    memory_category_t& operator+=(const memory_category_t& other)
+    {
+        count += other.count;
+        node_bytes += other.node_bytes;
+        string_bytes += other.string_bytes;
+        slack_bytes += other.slack_bytes;
+        box_bytes += other.box_bytes;
+        return *this;
+    }
+};
+
+struct memory_usage_t
+{
+    static constexpr std::size_t type_count = static_cast<std::size_t>(value_type_t::sorted_map) + 1;
+
+    std::array<memory_category_t, type_count> by_type = {};
+
+    const memory_category_t& operator[](value_type_t type) const { return by_type[static_cast<std::size_t>(type)]; }
+    memory_category_t& operator[](value_type_t type) { return by_type[static_cast<std::size_t>(type)]; }
+
+    memory_category_t total() const
+    {
+        memory_category_t result = {};
+        for (const memory_category_t& category : by_type)
+        {
+            result += category;
+        }
+        return result;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const memory_usage_t& item)
+    {
+        for (std::size_t i = 0; i < type_count; ++i)
+        {
+            const memory_category_t& category = item.by_type[i];
+            if (category.count == 0)
+            {
+                continue;
+            }
+            os << static_cast<value_type_t>(i) << ": count=" << category.count << " nodes=" << category.node_bytes
+               << " strings=" << category.string_bytes << " slack=" << category.slack_bytes
+               << " boxes=" << category.box_bytes << " total=" << category.total() << "\n";
+        }
+        return os << "total: " << item.total().total() << "\n";
+    }
+};
+
+namespace detail
+{
+
+// Approximate per-node bookkeeping of std::set: color and three links.
+constexpr std::size_t set_node_overhead = 4 * sizeof(void*);
+
+inline std::size_t heap_string_bytes(const std::string& s)
+{
+    static const std::size_t inline_capacity = std::string{}.capacity();
+    return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+}
+
+class memory_counter_t
+{
+public:
+    explicit memory_counter_t(memory_usage_t& usage) : m_usage(usage) { }
+
+    // `value` occupies a value_t slot counted by the caller's container (or the root).
+    void add(const value_t& value)
+    {
+        memory_category_t& category = m_usage[value.type()];
+        category.count += 1;
+        category.node_bytes += sizeof(value_t);
+        std::visit(unboxing_visitor{ [&](const auto& item) { content(category, item); } }, value.m_data);
+    }
+
+private:
+    memory_usage_t& m_usage;
+
+    template <class T>
+    void content(memory_category_t&, const T&)
+    {
+    }
+
+    void content(memory_category_t& category, const string_t& v) { category.string_bytes += heap_string_bytes(v); }
+    void content(memory_category_t& category, const symbol_t& v) { category.string_bytes += heap_string_bytes(v); }
+    void content(memory_category_t& category, const keyword_t& v) { category.string_bytes += heap_string_bytes(v); }
+
+    template <class Sequence>
+    void sequence(memory_category_t& category, const Sequence& v)
+    {
+        category.box_bytes += sizeof(Sequence);
+        category.slack_bytes += (v.capacity() - v.size()) * sizeof(value_t);
+        for (const value_t& item : v)
+        {
+            add(item);
+        }
+    }
+
+    void content(memory_category_t& category, const vector_t& v) { sequence(category, v); }
+    void content(memory_category_t& category, const list_t& v) { sequence(category, v); }
+
+    void content(memory_category_t& category, const set_t& v)
+    {
+        category.box_bytes += sizeof(set_t) + v.size() * set_node_overhead;
+        for (const value_t& item : v)
+        {
+            add(item);
+        }
+    }
+
+    void content(memory_category_t& category, const map_t& v)
+    {
+        category.box_bytes += sizeof(map_t);
+        category.slack_bytes += (v.m_items.capacity() - v.m_items.size()) * sizeof(map_t::value_type);
+        for (const auto& [key, item] : v)
+        {
+            add(key);
+            add(item);
+        }
+    }
+
+    template <class Tree>
+    void tree(memory_category_t& category, const Tree& v)
+    {
+        const auto nodes = v.node_memory();
+        category.box_bytes += sizeof(Tree) + nodes.structure_bytes;
+        category.slack_bytes += nodes.slack_bytes;
+    }
+
+    void content(memory_category_t& category, const sorted_set_t& v)
+    {
+        tree(category, v);
+        for (const value_t& item : v)
+        {
+            add(item);
+        }
+    }
+
+    void content(memory_category_t& category, const sorted_map_t& v)
+    {
+        tree(category, v);
+        for (const auto& [key, item] : v)
+        {
+            add(key);
+            add(item);
+        }
+    }
+
+    void content(memory_category_t& category, const tagged_element_t& v)
+    {
+        category.string_bytes += heap_string_bytes(v.tag());
+        add(v.element());
+    }
+
+    void content(memory_category_t&, const quoted_element_t& v) { add(v.element()); }
+
+    void content(memory_category_t& category, const callable_t&) { category.box_bytes += sizeof(callable_t); }
+
+    void content(memory_category_t& category, const atom_t&) { category.box_bytes += sizeof(atom_t::state_t); }
+
+    void content(memory_category_t& category, const future_t&) { category.box_bytes += sizeof(future_t::state_t); }
+};
+
+}  // namespace detail
+
+// Deep breakdown of the memory held by `value`, by type of the values it contains.
+inline memory_usage_t memory_usage(const value_t& value)
+{
+    memory_usage_t result = {};
+    detail::memory_counter_t{ result }.add(value);
+    return result;
+}
+
+}  // namespace edn
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <edn/thread_pool.hpp>
+#include <edn/writer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define EDN_HAS_WRITEV 1
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#else
+#define EDN_HAS_WRITEV 0
+#endif
+
+namespace edn
+{
+
+struct parallel_writer_options_t
+{
+    // Layout of the output; buffer_size is not used.
+    writer_options_t format = {};
+    // Elements (or map entries) of the collection formatted by one task.
+    std::size_t chunk_size = 1024;
+    // Chunks formatted ahead of the output, bounding the memory held by their buffers; 4 per worker if 0.
+    std::size_t max_in_flight = 0;
+    // Formatting workers; the default pool if null. write_parallel() must not be called from one of its workers.
+    thread_pool* pool = nullptr;
+};
+
+namespace detail
+{
+
+// Formats the elements of the collection `value` in chunks on the pool, each into a buffer of its own, and hands the
+// buffers to `sink` in order, in batches of those that are ready. Buffers come back for reuse once the sink returns.
+// Values that are not collections, or have no more than one chunk of elements, are formatted on the calling thread.
+template <class Sink>
+void write_parallel_chunks(const value_t& value, const parallel_writer_options_t& options, Sink sink)
+{
+    std::vector<std::string> batch(1);
+    const auto write_inline = [&]()
+    {
+        edn_formatter_t{ batch.front(), options.format }.write(value, 0);
+        batch.front() += '\n';
+        sink(batch);
+    };
+    const std::size_t chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+    const auto write_chunks = [&](std::string_view open, const auto& items, char close, auto format_element)
+    {
+        if (items.size() <= chunk_size)
+        {
+            write_inline();
+            return;
+        }
+        thread_pool& pool = options.pool ? *options.pool : thread_pool::default_pool();
+        const std::size_t max_in_flight = options.max_in_flight > 0 ? options.max_in_flight : 4 * pool.size();
+
+        // Separators of an element: a line of its own in the pretty layout, a space between elements otherwise.
+        const auto format_chunk = [&options, format_element](auto first, auto last, bool leading, std::string& out)
+        {
+            edn_formatter_t chunk_formatter{ out, options.format };
+            for (; first != last; ++first)
+            {
+                if (options.format.pretty)
+                {
+                    chunk_formatter.write_indent(1);
+                }
+                else if (leading)
+                {
+                    out += ' ';
+                }
+                leading = true;
+                format_element(chunk_formatter, *first);
+            }
+        };
+
+        std::deque<std::future<std::string>> pending;
+        std::vector<std::string> spare;
+        const auto drain = [&]()
+        {
+            batch.clear();
+            batch.push_back(pending.front().get());
+            pending.pop_front();
+            while (!pending.empty() && batch.size() < 64
+                   && pending.front().wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready)
+            {
+                batch.push_back(pending.front().get());
+                pending.pop_front();
+            }
+            sink(batch);
+            for (std::string& buffer : batch)
+            {
+                buffer.clear();
+                spare.push_back(std::move(buffer));
+            }
+        };
+
+        batch.front() += open;
+        sink(batch);
+        batch.front().clear();
+        try
+        {
+            auto it = items.begin();
+            for (std::size_t index = 0; index < items.size(); index += chunk_size)
+            {
+                const auto first = it;
+                std::advance(it, static_cast<std::ptrdiff_t>(std::min(chunk_size, items.size() - index)));
+                if (pending.size() >= max_in_flight)
+                {
+                    drain();
+                }
+                std::string buffer;
+                if (!spare.empty())
+                {
+                    buffer = std::move(spare.back());
+                    spare.pop_back();
+                }
+                const auto task = std::make_shared<std::packaged_task<std::string()>>(
+                    [format_chunk, first, last = it, leading = index > 0, buffer = std::move(buffer)]() mutable
+                    {
+                        format_chunk(first, last, leading, buffer);
+                        return std::move(buffer);
+                    });
+                pending.push_back(task->get_future());
+                pool.submit([task]() { (*task)(); });
+            }
+            while (!pending.empty())
+            {
+                drain();
+            }
+        }
+        catch (...)
+        {
+            // The tasks still refer to `value`; let them finish before unwinding.
+            for (std::future<std::string>& future : pending)
+            {
+                if (future.valid())
+                {
+                    future.wait();
+                }
+            }
+            throw;
+        }
+        batch.assign(1, std::string{});
+        if (options.format.pretty)
+        {
+            batch.front() += '\n';
+        }
+        batch.front() += close;
+        batch.front() += '\n';
+        sink(batch);
+    };
+
+    const auto format_value = [](edn_formatter_t& out, const value_t& element) { out.write(element, 1); };
+    const auto format_entry = [](edn_formatter_t& out, const auto& entry)
+    { out.write_entry(entry.first, entry.second, 1); };
+    switch (value.type())
+    {
+        case value_type_t::vector: write_chunks("[", *value.if_vector(), ']', format_value); return;
+        case value_type_t::list: write_chunks("(", *value.if_list(), ')', format_value); return;
+        case value_type_t::set: write_chunks("#{", *value.if_set(), '}', format_value); return;
+        case value_type_t::sorted_set: write_chunks("#{", *value.if_sorted_set(), '}', format_value); return;
+        case value_type_t::map: write_chunks("{", *value.if_map(), '}', format_entry); return;
+        case value_type_t::sorted_map: write_chunks("{", *value.if_sorted_map(), '}', format_entry); return;
+        default: write_inline(); return;
+    }
+}
+
+}  // namespace detail
+
+// Writes `value` followed by a newline, as stream_writer would, formatting the elements of a large top-level
+// collection in parallel. The output is the same as with a single thread.
+inline void write_parallel(std::ostream& os, const value_t& value, const parallel_writer_options_t& options = {})
+{
+    detail::write_parallel_chunks(
+        value,
+        options,
+        [&os](const std::vector<std::string>& buffers)
+        {
+            for (const std::string& buffer : buffers)
+            {
+                os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            }
+        });
+}
+
+#if EDN_HAS_WRITEV
+
+// As above, writing to the file descriptor `fd`: every batch of formatted chunks goes out with one writev() call,
+// straight from the chunk buffers.
+inline void write_parallel(int fd, const value_t& value, const parallel_writer_options_t& options = {})
+{
+    std::vector<iovec> vectors;
+    detail::write_parallel_chunks(
+        value,
+        options,
+        [fd, &vectors](std::vector<std::string>& buffers)
+        {
+            vectors.clear();
+            for (std::string& buffer : buffers)
+            {
+                if (!buffer.empty())
+                {
+                    vectors.push_back(iovec{ buffer.data(), buffer.size() });
+                }
+            }
+            std::size_t done = 0;
+            while (done < vectors.size())
+            {
+                const int count = static_cast<int>(std::min<std::size_t>(vectors.size() - done, IOV_MAX));
+                const ssize_t written = ::writev(fd, vectors.data() + done, count);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw std::runtime_error{ str("writer: cannot write: ", std::strerror(errno)) };
+                }
+                // Skip what was written, which may end in the middle of a buffer.
+                auto remaining = static_cast<std::size_t>(written);
+                while (done < vectors.size() && remaining >= vectors[done].iov_len)
+                {
+                    remaining -= vectors[done++].iov_len;
+                }
+                if (remaining > 0)
+                {
+                    vectors[done].iov_base = static_cast<char*>(vectors[done].iov_base) + remaining;
+                    vectors[done].iov_len -= remaining;
+                }
+            }
+        });
+}
+
+#endif
+
+}  // namespace edn
@@ -0,0 +1,543 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <edn/evaluate.hpp>
+#include <edn/spsc_queue.hpp>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace edn
+{
+
+namespace detail
+{
+
+// Cuts a character stream into the text of its top-level forms, tracking only nesting, strings, character literals,
+// comments and prefixes (quote, tags, discard) that bind to the following form. Malformed input is passed through
+// for the parser to report.
+class form_splitter_t
+{
+public:
+    // Feeds `chunk`; calls `emit(text)` for every top-level form completed by it.
+    template <class Emit>
+    void feed(std::string_view chunk, Emit&& emit)
+    {
+        for (const char c : chunk)
+        {
+            step(c, emit);
+        }
+    }
+
+    // Emits what is left at the end of the input.
+    template <class Emit>
+    void finish(Emit&& emit)
+    {
+        if (m_state == state_t::token)
+        {
+            end_token(emit);
+        }
+        if (has_content())
+        {
+            emit(std::move(m_text));
+        }
+        m_text.clear();
+    }
+
+private:
+    enum class state_t
+    {
+        normal,
+        token,
+        string,
+        string_escape,
+        comment,
+        hash,
+        character
+    };
+
+    std::string m_text;
+    state_t m_state = state_t::normal;
+    int m_depth = 0;
+    int m_prefixes = 0;  // prefixes at depth 0 still waiting for their form
+    bool m_tag = false;  // the current token is a tag
+
+    bool has_content() const
+    {
+        return m_text.find_first_not_of(" \t\r\n,") != std::string::npos;
+    }
+
+    static bool is_delimiter(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',' || c == '(' || c == ')' || c == '['
+               || c == ']' || c == '{' || c == '}' || c == '"' || c == ';';
+    }
+
+    template <class Emit>
+    void complete(Emit& emit)
+    {
+        if (m_depth != 0)
+        {
+            return;
+        }
+        // The form completes every prefix waiting for it.
+        m_prefixes = 0;
+        emit(std::move(m_text));
+        m_text.clear();
+    }
+
+    template <class Emit>
+    void end_token(Emit& emit)
+    {
+        m_state = state_t::normal;
+        if (m_tag)
+        {
+            m_tag = false;
+            if (m_depth == 0)
+            {
+                ++m_prefixes;
+            }
+            return;
+        }
+        complete(emit);
+    }
+
+    template <class Emit>
+    void step(char c, Emit& emit)
+    {
+        switch (m_state)
+        {
+            case state_t::comment:
+                if (c == '\n')
+                {
+                    m_state = state_t::normal;
+                }
+                if (m_depth > 0 || m_prefixes > 0)
+                {
+                    m_text += c;
+                }
+                return;
+            case state_t::string:
+                m_text += c;
+                if (c == '\\')
+                {
+                    m_state = state_t::string_escape;
+                }
+                else if (c == '"')
+                {
+                    m_state = state_t::normal;
+                    complete(emit);
+                }
+                return;
+            case state_t::string_escape:
+                m_text += c;
+                m_state = state_t::string;
+                return;
+            case state_t::character:
+                // The character after a backslash belongs to the literal even if it is a delimiter.
+                m_text += c;
+                m_state = state_t::token;
+                return;
+            case state_t::hash:
+                m_state = state_t::normal;
+                if (c == '{')
+                {
+                    m_text += c;
+                    ++m_depth;
+                    return;
+                }
+                if (c == '_')
+                {
+                    m_text += c;
+                    if (m_depth == 0)
+                    {
+                        ++m_prefixes;
+                    }
+                    return;
+                }
+                m_state = state_t::token;
+                m_tag = c != '#';  // ##Inf and ##NaN are values, anything else is a tag
+                break;
+            case state_t::token:
+                if (!is_delimiter(c))
+                {
+                    m_text += c;
+                    return;
+                }
+                end_token(emit);
+                break;
+            case state_t::normal: break;
+        }
+        if (m_state == state_t::token)
+        {
+            m_text += c;
+            return;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',')
+        {
+            if (has_content())
+            {
+                m_text += c;
+            }
+            return;
+        }
+        m_text += c;
+        switch (c)
+        {
+            case ';':
+                m_text.pop_back();
+                m_state = state_t::comment;
+                break;
+            case '"': m_state = state_t::string; break;
+            case '(':
+            case '[':
+            case '{': ++m_depth; break;
+            case ')':
+            case ']':
+            case '}':
+                if (m_depth > 0)
+                {
+                    --m_depth;
+                }
+                complete(emit);
+                break;
+            case '#': m_state = state_t::hash; break;
+            case '\'':
+                if (m_depth == 0)
+                {
+                    ++m_prefixes;
+                }
+                break;
+            case '\\': m_state = state_t::character; break;
+            default: m_state = state_t::token; break;
+        }
+    }
+};
+
+}  // namespace detail
+
+struct pipeline_stage_statistics
+{
+    std::string name;
+    std::size_t records_in = 0;
+    std::size_t records_out = 0;
+    std::size_t errors = 0;
+    // Time spent working on records, excluding waits on the neighbouring queues.
+    std::chrono::nanoseconds busy = {};
+};
+
+struct pipeline_statistics
+{
+    std::vector<pipeline_stage_statistics> stages;
+    std::chrono::nanoseconds elapsed = {};
+
+    friend std::ostream& operator<<(std::ostream& os, const pipeline_statistics& item)
+    {
+        const double seconds = std::chrono::duration<double>(item.elapsed).count();
+        for (const pipeline_stage_statistics& stage : item.stages)
+        {
+            const double busy = std::chrono::duration<double>(stage.busy).count();
+            os << stage.name << ": in=" << stage.records_in << " out=" << stage.records_out
+               << " errors=" << stage.errors << " busy=" << busy << "s";
+            if (busy > 0)
+            {
+                os << " rate=" << static_cast<std::size_t>(static_cast<double>(stage.records_in) / busy) << "/s";
+            }
+            os << "\n";
+        }
+        return os << "elapsed: " << seconds << "s\n";
+    }
+};
+
+struct pipeline_options_t
+{
+    // Capacity of each queue between two stages.
+    std::size_t queue_capacity = 1024;
+    // Bytes read from the input at a time.
+    std::size_t read_size = 64 * 1024;
+    // Writes records with pretty_print instead of one per line.
+    bool pretty = false;
+    // Called for records that fail to parse or transform, which are then dropped; without it the pipeline stops and
+    // run() rethrows the first error.
+    std::function<void(const std::string& stage, const std::exception& error)> on_error = {};
+};
+
+// Reads top-level forms from a stream, parses them, passes them through a chain of transforms and writes the
+// results, every stage on its own thread. Stages are connected by bounded lock-free queues, so a slow stage holds
+// back the ones before it instead of letting records pile up, and records come out in input order.
+class pipeline_t
+{
+public:
+    // Returns the transformed record, or nothing to drop it.
+    using transform_type = std::function<std::optional<value_t>(value_t)>;
+
+    explicit pipeline_t(pipeline_options_t options = {}) : m_options(std::move(options)) { }
+
+    pipeline_t& transform(std::string name, transform_type func)
+    {
+        m_transforms.push_back(stage_t{ std::move(name), std::move(func) });
+        return *this;
+    }
+
+    // Transform by an evaluator program evaluating to a function of one argument, e.g. `(fn [r] (if (valid? r) r nil))`,
+    // with `bindings` in scope. The program is evaluated once, in a scope owned by the stage. A nil result drops the
+    // record.
+    pipeline_t& transform(std::string name, const value_t& program, stack_t::frame_type bindings = {})
+    {
+        const auto stack = std::make_shared<stack_t>(std::move(bindings), nullptr);
+        const value_t func = evaluate(program, *stack);
+        if (!func.if_callable())
+        {
+            throw std::runtime_error{ str("pipeline: transform '", name, "' is not a function: ", func) };
+        }
+        const callable_t callable = *func.if_callable();
+        return transform(
+            std::move(name),
+            [stack, callable](value_t record) -> std::optional<value_t>
+            {
+                value_t result = callable({ std::move(record) });
+                if (result.is_nil())
+                {
+                    return std::nullopt;
+                }
+                return result;
+            });
+    }
+
+    pipeline_t& filter(std::string name, std::function<bool(const value_t&)> predicate)
+    {
+        return transform(
+            std::move(name),
+            [predicate = std::move(predicate)](value_t record) -> std::optional<value_t>
+            {
+                if (!predicate(record))
+                {
+                    return std::nullopt;
+                }
+                return record;
+            });
+    }
+
+    pipeline_statistics run(std::istream& input, std::ostream& output)
+    {
+        using text_queue_t = detail::spsc_queue_t<std::optional<std::string>>;
+        using value_queue_t = detail::spsc_queue_t<std::optional<value_t>>;
+
+        const auto start = std::chrono::steady_clock::now();
+        m_failed = false;
+        m_error = nullptr;
+        pipeline_statistics result = {};
+        result.stages.resize(m_transforms.size() + 3);
+        result.stages.front().name = "read";
+        result.stages[1].name = "parse";
+        for (std::size_t i = 0; i < m_transforms.size(); ++i)
+        {
+            result.stages[i + 2].name = m_transforms[i].m_name;
+        }
+        result.stages.back().name = "write";
+
+        text_queue_t texts{ m_options.queue_capacity };
+        std::vector<std::unique_ptr<value_queue_t>> values;
+        for (std::size_t i = 0; i <= m_transforms.size(); ++i)
+        {
+            values.push_back(std::make_unique<value_queue_t>(m_options.queue_capacity));
+        }
+
+        std::vector<std::thread> threads;
+        threads.emplace_back([&]() { read(input, texts, result.stages[0]); });
+        threads.emplace_back([&]() { parse(texts, *values.front(), result.stages[1]); });
+        for (std::size_t i = 0; i < m_transforms.size(); ++i)
+        {
+            threads.emplace_back([&, i]() { apply(m_transforms[i], *values[i], *values[i + 1], result.stages[i + 2]); });
+        }
+        threads.emplace_back([&]() { write(*values.back(), output, result.stages.back()); });
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        if (m_error)
+        {
+            std::rethrow_exception(m_error);
+        }
+        return result;
+    }
+
+private:
+    struct stage_t
+    {
+        std::string m_name;
+        transform_type m_func;
+    };
+
+    pipeline_options_t m_options;
+    std::vector<stage_t> m_transforms;
+
+    std::atomic<bool> m_failed = false;
+    std::mutex m_error_mutex;
+    std::exception_ptr m_error;
+
+    class busy_timer_t
+    {
+    public:
+        explicit busy_timer_t(pipeline_stage_statistics& stage) : m_stage(stage), m_start(clock_t::now()) { }
+
+        ~busy_timer_t() { m_stage.busy += std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - m_start); }
+
+    private:
+        using clock_t = std::chrono::steady_clock;
+        pipeline_stage_statistics& m_stage;
+        clock_t::time_point m_start;
+    };
+
+    // Reports an error of `stage`; returns true if the record is to be dropped and the pipeline continue.
+    bool report(pipeline_stage_statistics& stage, const std::exception& error)
+    {
+        ++stage.errors;
+        if (m_options.on_error)
+        {
+            m_options.on_error(stage.name, error);
+            return true;
+        }
+        std::lock_guard<std::mutex> lock{ m_error_mutex };
+        if (!m_error)
+        {
+            m_error = std::current_exception();
+        }
+        m_failed = true;
+        return false;
+    }
+
+    void read(std::istream& input, detail::spsc_queue_t<std::optional<std::string>>& out, pipeline_stage_statistics& stage)
+    {
+        detail::form_splitter_t splitter;
+        std::vector<std::string> forms;
+        const auto emit = [&](std::string text) { forms.push_back(std::move(text)); };
+        std::string buffer(m_options.read_size, '\0');
+        bool eof = false;
+        while (!eof && !m_failed)
+        {
+            {
+                const busy_timer_t timer{ stage };
+                input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                const auto count = static_cast<std::size_t>(input.gcount());
+                eof = count < buffer.size();
+                splitter.feed(std::string_view{ buffer.data(), count }, emit);
+                if (eof)
+                {
+                    splitter.finish(emit);
+                }
+            }
+            for (std::string& form : forms)
+            {
+                ++stage.records_out;
+                out.push(std::move(form));
+            }
+            forms.clear();
+        }
+        stage.records_in = stage.records_out;
+        out.push(std::nullopt);
+    }
+
+    void parse(
+        detail::spsc_queue_t<std::optional<std::string>>& in,
+        detail::spsc_queue_t<std::optional<value_t>>& out,
+        pipeline_stage_statistics& stage)
+    {
+        while (std::optional<std::string> text = in.pop())
+        {
+            ++stage.records_in;
+            if (m_failed)
+            {
+                continue;
+            }
+            std::vector<value_t> parsed;
+            try
+            {
+                const busy_timer_t timer{ stage };
+                parsed = detail::parse_fn::read_values(*text);
+            }
+            catch (const std::exception& error)
+            {
+                report(stage, error);
+                continue;
+            }
+            for (value_t& value : parsed)
+            {
+                ++stage.records_out;
+                out.push(std::move(value));
+            }
+        }
+        out.push(std::nullopt);
+    }
+
+    void apply(
+        const stage_t& transform,
+        detail::spsc_queue_t<std::optional<value_t>>& in,
+        detail::spsc_queue_t<std::optional<value_t>>& out,
+        pipeline_stage_statistics& stage)
+    {
+        while (std::optional<value_t> record = in.pop())
+        {
+            ++stage.records_in;
+            if (m_failed)
+            {
+                continue;
+            }
+            std::optional<value_t> result;
+            try
+            {
+                const busy_timer_t timer{ stage };
+                result = transform.m_func(std::move(*record));
+            }
+            catch (const std::exception& error)
+            {
+                report(stage, error);
+                continue;
+            }
+            if (result)
+            {
+                ++stage.records_out;
+                out.push(std::move(result));
+            }
+        }
+        out.push(std::nullopt);
+    }
+
+    void write(detail::spsc_queue_t<std::optional<value_t>>& in, std::ostream& output, pipeline_stage_statistics& stage)
+    {
+        while (std::optional<value_t> record = in.pop())
+        {
+            ++stage.records_in;
+            if (m_failed)
+            {
+                continue;
+            }
+            const busy_timer_t timer{ stage };
+            if (m_options.pretty)
+            {
+                pretty_print(output, *record);
+            }
+            else
+            {
+                output << *record << "\n";
+            }
+            ++stage.records_out;
+        }
+        output.flush();
+    }
+};
+
+}  // namespace edn
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace edn
+{
+
+struct reclaimer_statistics
+{
+    std::size_t retired = 0;
+    std::size_t reclaimed = 0;
+    std::size_t destroyed_inline = 0;
+    std::size_t queue_depth = 0;
+    std::size_t max_queue_depth = 0;
+    std::chrono::nanoseconds last_reclaim = {};
+    std::chrono::nanoseconds max_reclaim = {};
+    std::chrono::nanoseconds total_reclaim = {};
+};
+
+// What retire() does when the queue is full.
+enum class reclaimer_overflow_t
+{
+    destroy_inline,  // destroy the tree on the calling thread
+    block            // wait until the reclaimer has made room
+};
+
+// Destroys retired trees on a background thread, so that dropping a large value costs the caller a move instead of
+// freeing every node. The queue is bounded so that a reclaimer falling behind cannot hold an unbounded amount of
+// memory. Trees are destroyed in retirement order; the destructor reclaims everything still queued.
+class deferred_reclaimer
+{
+public:
+    explicit deferred_reclaimer(
+        std::size_t capacity = 64, reclaimer_overflow_t overflow = reclaimer_overflow_t::destroy_inline)
+        : m_capacity(std::max<std::size_t>(capacity, 1))
+        , m_overflow(overflow)
+        , m_thread([this]() { run(); })
+    {
+    }
+
+    deferred_reclaimer(const deferred_reclaimer&) = delete;
+    deferred_reclaimer& operator=(const deferred_reclaimer&) = delete;
+
+    ~deferred_reclaimer()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stop = true;
+        }
+        m_not_empty.notify_one();
+        m_thread.join();
+    }
+
+    // Takes ownership of `value`, leaving it nil. Values that own no collection are destroyed in place, as that is
+    // cheaper than queueing them.
+    void retire(value_t& value) { retire(std::exchange(value, value_t{})); }
+
+    void retire(value_t&& value)
+    {
+        value_t retired = std::move(value);
+        if (!owns_collection(retired))
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        if (m_queue.size() >= m_capacity)
+        {
+            if (m_overflow == reclaimer_overflow_t::destroy_inline)
+            {
+                ++m_statistics.destroyed_inline;
+                lock.unlock();
+                return;  // `retired` goes out of scope here
+            }
+            m_not_full.wait(lock, [this]() { return m_queue.size() < m_capacity; });
+        }
+        m_queue.push_back(std::move(retired));
+        ++m_statistics.retired;
+        m_statistics.max_queue_depth = std::max(m_statistics.max_queue_depth, m_queue.size());
+        lock.unlock();
+        m_not_empty.notify_one();
+    }
+
+    // Blocks until every tree retired so far has been destroyed.
+    void drain()
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_not_full.wait(lock, [this]() { return m_queue.empty() && !m_busy; });
+    }
+
+    reclaimer_statistics statistics() const
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        reclaimer_statistics result = m_statistics;
+        result.queue_depth = m_queue.size() + (m_busy ? 1 : 0);
+        return result;
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+
+private:
+    const std::size_t m_capacity;
+    const reclaimer_overflow_t m_overflow;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::deque<value_t> m_queue;
+    reclaimer_statistics m_statistics;
+    bool m_busy = false;
+    bool m_stop = false;
+
+    std::thread m_thread;
+
+    static bool owns_collection(const value_t& value)
+    {
+        switch (value.type())
+        {
+            case value_type_t::vector:
+            case value_type_t::list:
+            case value_type_t::set:
+            case value_type_t::map:
+            case value_type_t::tagged_element:
+            case value_type_t::quoted_element:
+            case value_type_t::callable:
+            case value_type_t::sorted_set:
+            case value_type_t::sorted_map: return true;
+            default: return false;
+        }
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        while (true)
+        {
+            m_not_empty.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                return;
+            }
+            value_t value = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            lock.unlock();
+            m_not_full.notify_all();
+
+            const auto start = std::chrono::steady_clock::now();
+            value = value_t{};
+            const auto elapsed
+                = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+            lock.lock();
+            m_busy = false;
+            ++m_statistics.reclaimed;
+            m_statistics.last_reclaim = elapsed;
+            m_statistics.max_reclaim = std::max(m_statistics.max_reclaim, elapsed);
+            m_statistics.total_reclaim += elapsed;
+            if (m_queue.empty())
+            {
+                m_not_full.notify_all();
+            }
+        }
+    }
+};
+
+}  // namespace edn
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <edn/thread_pool.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace edn
+{
+
+struct record_log_options_t
+{
+    // Map key of the records kept in a sparse index, e.g. :timestamp. Its values must not decrease from record to
+    // record; records that are not maps or lack the key have a nil key.
+    std::optional<value_t> key = {};
+    // Every n-th record is entered in the sparse index.
+    std::size_t key_interval = 64;
+    // Calls sync() after every append.
+    bool sync_on_append = false;
+};
+
+namespace detail
+{
+
+struct file_closer_t
+{
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+
+using file_ptr_t = std::unique_ptr<std::FILE, file_closer_t>;
+
+inline std::string read_file_range(const std::filesystem::path& path, std::uint64_t first, std::uint64_t last)
+{
+    std::ifstream file{ path, std::ios::binary };
+    std::string result(static_cast<std::size_t>(last - first), '\0');
+    file.seekg(static_cast<std::streamoff>(first));
+    file.read(result.data(), static_cast<std::streamsize>(result.size()));
+    if (!file)
+    {
+        throw std::runtime_error{ str("record_log: cannot read ", path.string()) };
+    }
+    return result;
+}
+
+inline void write_index_entry(std::FILE* file, std::uint64_t offset)
+{
+    std::array<unsigned char, 8> bytes = {};
+    for (std::size_t i = 0; i < bytes.size(); ++i)
+    {
+        bytes[i] = static_cast<unsigned char>(offset >> (8 * i));
+    }
+    if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size())
+    {
+        throw std::runtime_error{ "record_log: cannot write the offset index" };
+    }
+}
+
+inline std::uint64_t read_index_entry(const char* data)
+{
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        result |= std::uint64_t{ static_cast<unsigned char>(data[i]) } << (8 * i);
+    }
+    return result;
+}
+
+// Length of the first complete record of `text`: the shortest prefix ending with a newline that parses as exactly
+// one value (records may contain newlines inside strings). Zero if there is none.
+inline std::size_t complete_record_length(std::string_view text)
+{
+    for (std::size_t end = text.find('\n'); end != std::string_view::npos; end = text.find('\n', end + 1))
+    {
+        try
+        {
+            if (parse_fn::read_values(text.substr(0, end + 1)).size() == 1)
+            {
+                return end + 1;
+            }
+        }
+        catch (const std::exception&)
+        {
+        }
+    }
+    return 0;
+}
+
+}  // namespace detail
+
+// Append-only log of values, written as one EDN form per record to `path`. The start offset of every record is kept in
+// `path`.idx (8 bytes little endian per record), so record n is found with one lookup and read with one read. With
+// a key configured, `path`.keys holds `[n key]` for every key_interval-th record, which bounds a key lookup to
+// key_interval reads after a binary search.
+//
+// Records are written before their index entries. Opening a log re-checks its last indexed record and everything
+// after it: complete records missing from the index are indexed again, and a torn record at the end is cut off.
+// A log is not synchronized: appends must not run at the same time as reads or scans.
+class record_log
+{
+public:
+    explicit record_log(std::filesystem::path path, record_log_options_t options = {})
+        : m_path(std::move(path))
+        , m_index_path(m_path.string() + ".idx")
+        , m_keys_path(m_path.string() + ".keys")
+        , m_options(std::move(options))
+    {
+        m_options.key_interval = std::max<std::size_t>(m_options.key_interval, 1);
+        recover();
+        m_data = open(m_path);
+        m_index = open(m_index_path);
+        if (m_options.key)
+        {
+            recover_keys();
+        }
+    }
+
+    record_log(const record_log&) = delete;
+    record_log& operator=(const record_log&) = delete;
+
+    ~record_log()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const std::exception&)
+        {
+        }
+    }
+
+    const std::filesystem::path& path() const { return m_path; }
+
+    std::size_t size() const { return m_offsets.size(); }
+
+    bool empty() const { return m_offsets.empty(); }
+
+    // Records indexed again and bytes of torn data cut off when the log was opened.
+    std::size_t recovered_records() const { return m_recovered_records; }
+
+    std::uint64_t truncated_bytes() const { return m_truncated_bytes; }
+
+    // Appends `record` and returns its number.
+    std::size_t append(const value_t& record)
+    {
+        std::optional<value_t> key = {};
+        if (m_options.key)
+        {
+            key = key_of(record);
+            if (m_last_key && *key < *m_last_key)
+            {
+                throw std::runtime_error{ str("record_log: key ", *key, " is less than the previous key ", *m_last_key) };
+            }
+        }
+        const std::string text = str(record, '\n');
+        if (std::fwrite(text.data(), 1, text.size(), m_data.get()) != text.size())
+        {
+            throw std::runtime_error{ str("record_log: cannot write ", m_path.string()) };
+        }
+        const std::size_t number = m_offsets.size();
+        detail::write_index_entry(m_index.get(), m_end);
+        m_offsets.push_back(m_end);
+        m_end += text.size();
+        if (key)
+        {
+            if (number % m_options.key_interval == 0)
+            {
+                write_key(number, *key);
+            }
+            m_last_key = std::move(key);
+        }
+        if (m_options.sync_on_append)
+        {
+            sync();
+        }
+        return number;
+    }
+
+    // Record `number`; throws std::out_of_range past the end.
+    value_t read(std::size_t number)
+    {
+        if (number >= size())
+        {
+            throw std::out_of_range{ str("record_log: record ", number, " of ", size()) };
+        }
+        flush();
+        return parse(detail::read_file_range(m_path, m_offsets[number], end_of(number)));
+    }
+
+    // Number of the first record whose key is not less than `key`, or size() if there is none.
+    std::size_t lower_bound(const value_t& key)
+    {
+        if (!m_options.key)
+        {
+            throw std::runtime_error{ "record_log: lower_bound requires a key" };
+        }
+        const auto it = std::lower_bound(
+            m_sparse.begin(), m_sparse.end(), key, [](const auto& entry, const value_t& k) { return entry.second < k; });
+        std::size_t number = it == m_sparse.begin() ? 0 : std::prev(it)->first;
+        while (number < size() && key_of(read(number)) < key)
+        {
+            ++number;
+        }
+        return number;
+    }
+
+    // Calls `callback(number, record)` for the records in [first, last), which are read and parsed in contiguous
+    // ranges on `pool` (the default pool if null). The callback runs concurrently on the workers, in no particular
+    // order; the first exception it throws is rethrown once all ranges are done.
+    void scan(std::size_t first,
+              std::size_t last,
+              const std::function<void(std::size_t, const value_t&)>& callback,
+              thread_pool* pool = nullptr)
+    {
+        last = std::min(last, size());
+        if (first >= last)
+        {
+            return;
+        }
+        flush();
+        thread_pool& workers = pool ? *pool : thread_pool::default_pool();
+        const std::size_t ranges = std::min(last - first, workers.size() * 4);
+        std::vector<future_t> futures;
+        futures.reserve(ranges);
+        for (std::size_t r = 0; r < ranges; ++r)
+        {
+            const std::size_t begin = first + (last - first) * r / ranges;
+            const std::size_t end = first + (last - first) * (r + 1) / ranges;
+            futures.push_back(workers.async(
+                [this, begin, end, &callback]() -> value_t
+                {
+                    scan_range(begin, end, callback);
+                    return value_t{};
+                }));
+        }
+        for (const future_t& future : futures)
+        {
+            workers.wait(future);
+        }
+        for (const future_t& future : futures)
+        {
+            workers.deref(future);
+        }
+    }
+
+    void scan(const std::function<void(std::size_t, const value_t&)>& callback, thread_pool* pool = nullptr)
+    {
+        scan(0, size(), callback, pool);
+    }
+
+    // Hands buffered records to the operating system.
+    void flush()
+    {
+        for (std::FILE* file : { m_data.get(), m_index.get(), m_keys.get() })
+        {
+            if (file && std::fflush(file) != 0)
+            {
+                throw std::runtime_error{ str("record_log: cannot flush ", m_path.string()) };
+            }
+        }
+    }
+
+    // Flushes and waits until the records are on disk, data before index.
+    void sync()
+    {
+        flush();
+        for (std::FILE* file : { m_data.get(), m_index.get(), m_keys.get() })
+        {
+#if defined(_WIN32)
+            const int result = file ? ::_commit(::_fileno(file)) : 0;
+#else
+            const int result = file ? ::fsync(::fileno(file)) : 0;
+#endif
+            if (result != 0)
+            {
+                throw std::runtime_error{ str("record_log: cannot sync ", m_path.string()) };
+            }
+        }
+    }
+
+private:
+    static detail::file_ptr_t open(const std::filesystem::path& path)
+    {
+        detail::file_ptr_t result{ std::fopen(path.string().c_str(), "ab") };
+        if (!result)
+        {
+            throw std::runtime_error{ str("record_log: cannot open ", path.string()) };
+        }
+        return result;
+    }
+
+    static std::uint64_t file_size(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        const std::uintmax_t result = std::filesystem::file_size(path, error);
+        return error ? 0 : static_cast<std::uint64_t>(result);
+    }
+
+    static void truncate(const std::filesystem::path& path, std::uint64_t size)
+    {
+        if (std::filesystem::exists(path) && file_size(path) != size)
+        {
+            std::filesystem::resize_file(path, size);
+        }
+    }
+
+    value_t key_of(const value_t& record) const
+    {
+        if (const auto map = record.if_map())
+        {
+            const auto it = map->find(*m_options.key);
+            return it != map->end() ? it->second : value_t{};
+        }
+        return value_t{};
+    }
+
+    std::uint64_t end_of(std::size_t number) const { return number + 1 < size() ? m_offsets[number + 1] : m_end; }
+
+    void scan_range(std::size_t first, std::size_t last, const std::function<void(std::size_t, const value_t&)>& callback)
+    {
+        const std::uint64_t base = m_offsets[first];
+        const std::string text = detail::read_file_range(m_path, base, end_of(last - 1));
+        for (std::size_t number = first; number < last; ++number)
+        {
+            const std::size_t begin = static_cast<std::size_t>(m_offsets[number] - base);
+            const std::size_t end = static_cast<std::size_t>(end_of(number) - base);
+            callback(number, parse(std::string_view{ text }.substr(begin, end - begin)));
+        }
+    }
+
+    // Loads the offset index, keeping the entries that point into the data in increasing order, and rescans the data
+    // from the last of them.
+    void recover()
+    {
+        const std::uint64_t data_size = file_size(m_path);
+        const std::uint64_t index_size = file_size(m_index_path);
+        if (index_size > 0)
+        {
+            const std::string index = detail::read_file_range(m_index_path, 0, index_size - index_size % 8);
+            m_offsets.reserve(index.size() / 8);
+            for (std::size_t i = 0; i < index.size(); i += 8)
+            {
+                const std::uint64_t offset = detail::read_index_entry(index.data() + i);
+                if (offset >= data_size || (!m_offsets.empty() && offset <= m_offsets.back()))
+                {
+                    break;
+                }
+                m_offsets.push_back(offset);
+            }
+        }
+
+        const std::size_t loaded = m_offsets.size();
+        const std::size_t indexed = loaded == 0 ? 0 : loaded - 1;
+        m_end = loaded == 0 ? 0 : m_offsets.back();
+        m_offsets.resize(indexed);
+        if (m_end < data_size)
+        {
+            const std::string tail = detail::read_file_range(m_path, m_end, data_size);
+            std::string_view rest = tail;
+            while (const std::size_t length = detail::complete_record_length(rest))
+            {
+                m_offsets.push_back(m_end);
+                m_end += length;
+                rest.remove_prefix(length);
+            }
+        }
+        m_recovered_records = m_offsets.size() > loaded ? m_offsets.size() - loaded : 0;
+        m_truncated_bytes = data_size - m_end;
+        truncate(m_path, m_end);
+
+        if (loaded != m_offsets.size() || index_size != loaded * 8)
+        {
+            truncate(m_index_path, indexed * 8);
+            detail::file_ptr_t index = open(m_index_path);
+            for (std::size_t number = indexed; number < m_offsets.size(); ++number)
+            {
+                detail::write_index_entry(index.get(), m_offsets[number]);
+            }
+        }
+    }
+
+    // Loads the sparse index, keeping the entries of existing records, and adds the ones that are missing.
+    void recover_keys()
+    {
+        std::uint64_t valid = 0;
+        if (const std::uint64_t keys_size = file_size(m_keys_path))
+        {
+            const std::string keys = detail::read_file_range(m_keys_path, 0, keys_size);
+            std::string_view rest = keys;
+            while (const std::size_t length = detail::complete_record_length(rest))
+            {
+                const value_t entry = parse(rest.substr(0, length));
+                const auto pair = entry.if_vector();
+                const auto number = pair && pair->size() == 2 ? (*pair)[0].if_integer() : nullptr;
+                if (!number || *number < 0 || static_cast<std::size_t>(*number) >= size()
+                    || static_cast<std::size_t>(*number) % m_options.key_interval != 0
+                    || (!m_sparse.empty() && static_cast<std::size_t>(*number) <= m_sparse.back().first))
+                {
+                    break;
+                }
+                m_sparse.emplace_back(static_cast<std::size_t>(*number), (*pair)[1]);
+                valid += length;
+                rest.remove_prefix(length);
+            }
+        }
+        truncate(m_keys_path, valid);
+        m_keys = open(m_keys_path);
+        const std::size_t next = m_sparse.empty() ? 0 : m_sparse.back().first + m_options.key_interval;
+        for (std::size_t number = next; number < size(); number += m_options.key_interval)
+        {
+            write_key(number, key_of(read(number)));
+        }
+        if (!empty())
+        {
+            m_last_key = key_of(read(size() - 1));
+        }
+    }
+
+    void write_key(std::size_t number, const value_t& key)
+    {
+        const std::string text = str('[', number, ' ', key, "]\n");
+        if (std::fwrite(text.data(), 1, text.size(), m_keys.get()) != text.size())
+        {
+            throw std::runtime_error{ str("record_log: cannot write ", m_keys_path.string()) };
+        }
+        m_sparse.emplace_back(number, key);
+    }
+
+    std::filesystem::path m_path;
+    std::filesystem::path m_index_path;
+    std::filesystem::path m_keys_path;
+    record_log_options_t m_options;
+    detail::file_ptr_t m_data;
+    detail::file_ptr_t m_index;
+    detail::file_ptr_t m_keys;
+    std::vector<std::uint64_t> m_offsets;
+    std::uint64_t m_end = 0;
+    std::vector<std::pair<std::size_t, value_t>> m_sparse;
+    std::optional<value_t> m_last_key;
+    std::size_t m_recovered_records = 0;
+    std::uint64_t m_truncated_bytes = 0;
+};
+
+}  // namespace edn
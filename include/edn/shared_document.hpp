@@ -0,0 +1,169 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <edn/reclaimer.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace edn
+{
+
+// Holder of an immutable value that is read far more often than it is replaced. Reads are wait-free: a reader bumps
+// a counter of its shard for the current epoch and loads the current version, with no loop and no shared reference
+// count. publish() swaps in a new version and then waits for a grace period (as in sleepable RCU): the epoch is
+// flipped twice and the counters of each parity drain in turn, after which no reader can still see the old version,
+// which is destroyed or handed to a deferred_reclaimer. Writers are serialized; a thread must not publish while it
+// holds a read_guard of the same document.
+class shared_document
+{
+private:
+    struct version_t
+    {
+        value_t m_value;
+        std::uint64_t m_number;
+    };
+
+    struct alignas(64) shard_t
+    {
+        std::atomic<std::uint64_t> m_readers[2] = { 0, 0 };
+    };
+
+public:
+    class read_guard
+    {
+    public:
+        read_guard(read_guard&& other) noexcept
+            : m_readers(std::exchange(other.m_readers, nullptr))
+            , m_version(other.m_version)
+        {
+        }
+
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+        read_guard& operator=(read_guard&&) = delete;
+
+        ~read_guard()
+        {
+            if (m_readers)
+            {
+                m_readers->fetch_sub(1);
+            }
+        }
+
+        const value_t& operator*() const { return m_version->m_value; }
+        const value_t* operator->() const { return &m_version->m_value; }
+
+        // Number of the version being read, starting at 0 for the initial value.
+        std::uint64_t version() const { return m_version->m_number; }
+
+    private:
+        friend class shared_document;
+
+        std::atomic<std::uint64_t>* m_readers;
+        const version_t* m_version;
+
+        read_guard(std::atomic<std::uint64_t>* readers, const version_t* version)
+            : m_readers(readers)
+            , m_version(version)
+        {
+        }
+    };
+
+    explicit shared_document(value_t initial = {}, deferred_reclaimer* reclaimer = nullptr)
+        : m_current(new version_t{ std::move(initial), 0 })
+        , m_shards(new shard_t[shard_count])
+        , m_reclaimer(reclaimer)
+    {
+    }
+
+    shared_document(const shared_document&) = delete;
+    shared_document& operator=(const shared_document&) = delete;
+
+    // No reader may outlive the document.
+    ~shared_document() { retire(m_current.load()); }
+
+    // Pins the current version for as long as the guard lives.
+    read_guard read() const
+    {
+        std::atomic<std::uint64_t>& readers = m_shards[shard_index()].m_readers[m_epoch.load() & 1];
+        readers.fetch_add(1);
+        return read_guard{ &readers, m_current.load() };
+    }
+
+    // Copy of the current value, for callers that keep it beyond a read.
+    value_t snapshot() const { return *read(); }
+
+    // Installs `value` as the new version and reclaims the old one once every reader that could see it has finished.
+    void publish(value_t value)
+    {
+        std::lock_guard<std::mutex> lock{ m_write_mutex };
+        install(std::move(value));
+    }
+
+    // Publishes `func(current)`. Writers are serialized, so no update is lost.
+    template <class Func>
+    void update(Func&& func)
+    {
+        std::lock_guard<std::mutex> lock{ m_write_mutex };
+        install(std::forward<Func>(func)(static_cast<const value_t&>(m_current.load()->m_value)));
+    }
+
+    std::uint64_t version() const { return m_current.load()->m_number; }
+
+private:
+    static constexpr std::size_t shard_count = 16;
+
+    std::atomic<version_t*> m_current;
+    std::unique_ptr<shard_t[]> m_shards;
+    mutable std::atomic<std::uint64_t> m_epoch = 0;
+    std::mutex m_write_mutex;
+    deferred_reclaimer* m_reclaimer;
+
+    // Spreads reader threads over the shards to keep them off each other's cache lines.
+    static std::size_t shard_index()
+    {
+        static std::atomic<std::size_t> next = 0;
+        static thread_local const std::size_t index = next.fetch_add(1) % shard_count;
+        return index;
+    }
+
+    void install(value_t value)
+    {
+        version_t* const next = new version_t{ std::move(value), m_current.load()->m_number + 1 };
+        version_t* const previous = m_current.exchange(next);
+        synchronize();
+        retire(previous);
+    }
+
+    // Readers that loaded the previous version counted themselves before the exchange, in the parity of whichever
+    // epoch they saw. Each flip sends new readers to the other parity, so the old one drains.
+    void synchronize()
+    {
+        for (int flip = 0; flip < 2; ++flip)
+        {
+            const std::uint64_t parity = m_epoch.fetch_add(1) & 1;
+            for (std::size_t i = 0; i < shard_count; ++i)
+            {
+                while (m_shards[i].m_readers[parity].load() != 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    void retire(version_t* version)
+    {
+        const std::unique_ptr<version_t> owned{ version };
+        if (m_reclaimer)
+        {
+            m_reclaimer->retire(std::move(owned->m_value));
+        }
+    }
+};
+
+}  // namespace edn
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <edn/frozen.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define EDN_HAS_SHARED_FROZEN 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define EDN_HAS_SHARED_FROZEN 0
+#endif
+
+#if EDN_HAS_SHARED_FROZEN
+
+namespace edn
+{
+
+namespace detail
+{
+
+// Control segment of a shared frozen document: the number of the current version, 0 until one is published. Version
+// n is stored in the segment `name`.n, which is complete before the number is stored.
+struct shared_frozen_control_t
+{
+    char m_magic[8];
+    std::atomic<std::uint64_t> m_version;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the version must be usable across processes");
+
+static constexpr inline char shared_frozen_magic[8] = { 'E', 'D', 'N', 'S', 'H', 'M', '0', '1' };
+
+inline std::runtime_error shared_frozen_error(const std::string& what, const std::string& name)
+{
+    return std::runtime_error{ str("shared_frozen: cannot ", what, " ", name, ": ", std::strerror(errno)) };
+}
+
+class file_descriptor_t
+{
+public:
+    explicit file_descriptor_t(int fd) : m_fd(fd) { }
+
+    file_descriptor_t(const file_descriptor_t&) = delete;
+    file_descriptor_t& operator=(const file_descriptor_t&) = delete;
+
+    ~file_descriptor_t()
+    {
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+    }
+
+    int get() const { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+// A mapping of a whole segment, unmapped on destruction.
+class shared_mapping_t
+{
+public:
+    shared_mapping_t(int fd, std::size_t size, bool writable, const std::string& name) : m_size(size)
+    {
+        m_data = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (m_data == MAP_FAILED)
+        {
+            throw shared_frozen_error("map", name);
+        }
+    }
+
+    shared_mapping_t(const shared_mapping_t&) = delete;
+    shared_mapping_t& operator=(const shared_mapping_t&) = delete;
+
+    ~shared_mapping_t() { ::munmap(m_data, m_size); }
+
+    void* data() const { return m_data; }
+
+    std::size_t size() const { return m_size; }
+
+private:
+    void* m_data;
+    std::size_t m_size;
+};
+
+inline std::string shared_frozen_segment(const std::string& name, std::uint64_t version)
+{
+    return str(name, '.', version);
+}
+
+inline void check_shared_frozen_name(const std::string& name)
+{
+    if (name.size() < 2 || name.front() != '/' || name.find('/', 1) != std::string::npos)
+    {
+        throw std::runtime_error{ str("shared_frozen: invalid name '", name, "', expected /name") };
+    }
+}
+
+}  // namespace detail
+
+// One published version of a shared frozen document, mapped read-only. The mapping (and every view of root()) stays
+// valid while the snapshot is alive, even after newer versions have been published.
+class shared_frozen_snapshot
+{
+public:
+    shared_frozen_snapshot(std::uint64_t version, std::unique_ptr<detail::shared_mapping_t> mapping)
+        : m_version(version)
+        , m_mapping(std::move(mapping))
+        , m_root(frozen_root(m_mapping->data(), m_mapping->size()))
+    {
+    }
+
+    std::uint64_t version() const { return m_version; }
+
+    const void* data() const { return m_mapping->data(); }
+
+    std::size_t size() const { return m_mapping->size(); }
+
+    const frozen_value_t& root() const { return m_root; }
+
+private:
+    std::uint64_t m_version;
+    std::unique_ptr<detail::shared_mapping_t> m_mapping;
+    frozen_value_t m_root;
+};
+
+// Publishes frozen documents under a POSIX shared memory name (e.g. "/reference-data") for any number of readers in
+// other processes. Every version goes to a segment of its own, which is written in full before the version number
+// in the control segment is switched, so readers never see a partial document; the segment of the previous version
+// is unlinked, and its memory is released once the last reader unmaps it. There must be one publisher per name at
+// a time; a new publisher continues the version numbers of the previous one.
+class shared_frozen_publisher
+{
+public:
+    explicit shared_frozen_publisher(std::string name, mode_t mode = 0644) : m_name(std::move(name)), m_mode(mode)
+    {
+        detail::check_shared_frozen_name(m_name);
+        const detail::file_descriptor_t fd{ ::shm_open(m_name.c_str(), O_RDWR | O_CREAT, m_mode) };
+        if (fd.get() < 0)
+        {
+            throw detail::shared_frozen_error("create", m_name);
+        }
+        struct stat info = {};
+        if (::fstat(fd.get(), &info) != 0
+            || (static_cast<std::size_t>(info.st_size) < sizeof(detail::shared_frozen_control_t)
+                && ::ftruncate(fd.get(), sizeof(detail::shared_frozen_control_t)) != 0))
+        {
+            throw detail::shared_frozen_error("size", m_name);
+        }
+        m_control
+            = std::make_unique<detail::shared_mapping_t>(fd.get(), sizeof(detail::shared_frozen_control_t), true, m_name);
+        std::memcpy(control().m_magic, detail::shared_frozen_magic, sizeof(detail::shared_frozen_magic));
+    }
+
+    const std::string& name() const { return m_name; }
+
+    // Number of the current version, 0 if none has been published.
+    std::uint64_t version() const { return control().m_version.load(std::memory_order_acquire); }
+
+    // Copies the frozen block into a new segment, makes it the current version and returns its number.
+    std::uint64_t publish(const void* data, std::size_t size)
+    {
+        detail::validate_frozen(data, size);
+        const std::uint64_t previous = version();
+        const std::uint64_t next = previous + 1;
+        const std::string segment = detail::shared_frozen_segment(m_name, next);
+        ::shm_unlink(segment.c_str());
+        {
+            const detail::file_descriptor_t fd{ ::shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, m_mode) };
+            if (fd.get() < 0)
+            {
+                throw detail::shared_frozen_error("create", segment);
+            }
+            if (::ftruncate(fd.get(), static_cast<off_t>(size)) != 0)
+            {
+                ::shm_unlink(segment.c_str());
+                throw detail::shared_frozen_error("size", segment);
+            }
+            const detail::shared_mapping_t mapping{ fd.get(), size, true, segment };
+            std::memcpy(mapping.data(), data, size);
+        }
+        control().m_version.store(next, std::memory_order_release);
+        if (previous > 0)
+        {
+            ::shm_unlink(detail::shared_frozen_segment(m_name, previous).c_str());
+        }
+        return next;
+    }
+
+    std::uint64_t publish(const frozen_t& frozen) { return publish(frozen.data(), frozen.size()); }
+
+    std::uint64_t publish(const value_t& value) { return publish(freeze(value)); }
+
+    // Unlinks the control segment and the current version. Mapped snapshots remain readable.
+    static void remove(const std::string& name)
+    {
+        const detail::file_descriptor_t fd{ ::shm_open(name.c_str(), O_RDONLY, 0) };
+        struct stat info = {};
+        if (fd.get() >= 0 && ::fstat(fd.get(), &info) == 0
+            && static_cast<std::size_t>(info.st_size) >= sizeof(detail::shared_frozen_control_t))
+        {
+            const detail::shared_mapping_t mapping{ fd.get(), sizeof(detail::shared_frozen_control_t), false, name };
+            const auto& control = *static_cast<const detail::shared_frozen_control_t*>(mapping.data());
+            ::shm_unlink(detail::shared_frozen_segment(name, control.m_version.load()).c_str());
+        }
+        ::shm_unlink(name.c_str());
+    }
+
+private:
+    detail::shared_frozen_control_t& control() const
+    {
+        return *static_cast<detail::shared_frozen_control_t*>(m_control->data());
+    }
+
+    std::string m_name;
+    mode_t m_mode;
+    std::unique_ptr<detail::shared_mapping_t> m_control;
+};
+
+// Reads the documents published under a name. current() checks the version number with a single atomic load and
+// maps a newly published version on first use, so readers pick up updates without coordinating with the publisher.
+// Safe to use from several threads.
+class shared_frozen_reader
+{
+public:
+    explicit shared_frozen_reader(std::string name) : m_name(std::move(name))
+    {
+        detail::check_shared_frozen_name(m_name);
+    }
+
+    const std::string& name() const { return m_name; }
+
+    // Current version, or null if nothing has been published yet.
+    std::shared_ptr<const shared_frozen_snapshot> current()
+    {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (!m_control && !open_control())
+        {
+            return nullptr;
+        }
+        std::uint64_t version = control().m_version.load(std::memory_order_acquire);
+        while (version > 0 && (!m_snapshot || m_snapshot->version() != version))
+        {
+            const std::string segment = detail::shared_frozen_segment(m_name, version);
+            const detail::file_descriptor_t fd{ ::shm_open(segment.c_str(), O_RDONLY, 0) };
+            const int error = errno;
+            if (fd.get() >= 0)
+            {
+                struct stat info = {};
+                if (::fstat(fd.get(), &info) != 0)
+                {
+                    throw detail::shared_frozen_error("inspect", segment);
+                }
+                const auto size = static_cast<std::size_t>(info.st_size);
+                m_snapshot = std::make_shared<const shared_frozen_snapshot>(
+                    version, std::make_unique<detail::shared_mapping_t>(fd.get(), size, false, segment));
+                break;
+            }
+            // The version was replaced (and its segment unlinked) between reading the number and opening it.
+            const std::uint64_t latest = control().m_version.load(std::memory_order_acquire);
+            if (error != ENOENT || latest == version)
+            {
+                errno = error;
+                throw detail::shared_frozen_error("open", segment);
+            }
+            version = latest;
+        }
+        return version > 0 ? m_snapshot : nullptr;
+    }
+
+private:
+    bool open_control()
+    {
+        const detail::file_descriptor_t fd{ ::shm_open(m_name.c_str(), O_RDONLY, 0) };
+        struct stat info = {};
+        if (fd.get() < 0 || ::fstat(fd.get(), &info) != 0
+            || static_cast<std::size_t>(info.st_size) < sizeof(detail::shared_frozen_control_t))
+        {
+            return false;
+        }
+        auto mapping
+            = std::make_unique<detail::shared_mapping_t>(fd.get(), sizeof(detail::shared_frozen_control_t), false, m_name);
+        const auto& header = *static_cast<const detail::shared_frozen_control_t*>(mapping->data());
+        if (std::memcmp(header.m_magic, detail::shared_frozen_magic, sizeof(detail::shared_frozen_magic)) != 0)
+        {
+            return false;
+        }
+        m_control = std::move(mapping);
+        return true;
+    }
+
+    const detail::shared_frozen_control_t& control() const
+    {
+        return *static_cast<const detail::shared_frozen_control_t*>(m_control->data());
+    }
+
+    std::string m_name;
+    std::mutex m_mutex;
+    std::unique_ptr<detail::shared_mapping_t> m_control;
+    std::shared_ptr<const shared_frozen_snapshot> m_snapshot;
+};
+
+}  // namespace edn
+
+#endif
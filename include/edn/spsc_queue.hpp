@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace edn
+{
+
+namespace detail
+{
+
+// Bounded single-producer single-consumer ring. Each side caches the other side's index and only reloads it when
+// the ring looks full (or empty), so in steady state a push or a pop touches one shared cache line.
+template <class T>
+class spsc_queue_t
+{
+public:
+    explicit spsc_queue_t(std::size_t capacity) : m_slots(round_up(capacity)), m_mask(m_slots.size() - 1) { }
+
+    spsc_queue_t(const spsc_queue_t&) = delete;
+    spsc_queue_t& operator=(const spsc_queue_t&) = delete;
+
+    bool try_push(T& item)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cache == m_slots.size())
+        {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cache == m_slots.size())
+            {
+                return false;
+            }
+        }
+        m_slots[tail & m_mask] = std::move(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& item)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail_cache)
+        {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tail_cache)
+            {
+                return false;
+            }
+        }
+        item = std::move(m_slots[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Blocks while the queue is full, which is how a consumer falling behind holds back its producer.
+    void push(T item)
+    {
+        for (std::size_t attempt = 0; !try_push(item); ++attempt)
+        {
+            backoff(attempt);
+        }
+    }
+
+    // As push(), but gives up (returning false) once `stop` is set, for a producer whose consumer may go away.
+    bool push(T item, const std::atomic<bool>& stop)
+    {
+        for (std::size_t attempt = 0; !try_push(item); ++attempt)
+        {
+            if (stop)
+            {
+                return false;
+            }
+            backoff(attempt);
+        }
+        return true;
+    }
+
+    T pop()
+    {
+        T item = {};
+        for (std::size_t attempt = 0; !try_pop(item); ++attempt)
+        {
+            backoff(attempt);
+        }
+        return item;
+    }
+
+private:
+    std::vector<T> m_slots;
+    const std::size_t m_mask;
+
+    alignas(64) std::atomic<std::size_t> m_head = 0;
+    std::size_t m_tail_cache = 0;  // consumer's view of m_tail
+
+    alignas(64) std::atomic<std::size_t> m_tail = 0;
+    std::size_t m_head_cache = 0;  // producer's view of m_head
+
+    static std::size_t round_up(std::size_t capacity)
+    {
+        std::size_t result = 2;
+        while (result < capacity)
+        {
+            result *= 2;
+        }
+        return result;
+    }
+
+    static void backoff(std::size_t attempt)
+    {
+        if (attempt < 64)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds{ 50 });
+        }
+    }
+};
+
+}  // namespace detail
+
+}  // namespace edn
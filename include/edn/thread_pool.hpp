@@ -0,0 +1,258 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace edn
+{
+
+// Fixed-size pool with one task deque per worker. Workers pop their own deque from the front (most recently spawned
+// first) and steal from the back of the others when idle. Threads waiting on a result from inside the pool keep
+// executing queued tasks instead of blocking, so nested fan-out cannot starve the pool.
+class thread_pool
+{
+public:
+    using task_type = std::function<void()>;
+
+    explicit thread_pool(std::size_t size = default_size())
+    {
+        size = std::max<std::size_t>(size, 1);
+        m_queues.reserve(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_queues.push_back(std::make_unique<queue_t>());
+        }
+        m_threads.reserve(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_threads.emplace_back([this, i]() { worker_loop(i); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stop = true;
+        }
+        m_wakeup.notify_all();
+        for (std::thread& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::size_t size() const { return m_threads.size(); }
+
+    void submit(task_type task)
+    {
+        const std::size_t index = current_worker() ? *current_worker() : m_next.fetch_add(1) % m_queues.size();
+        queue_t& queue = *m_queues[index];
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            ++m_pending;
+        }
+        {
+            std::lock_guard<std::mutex> lock{ queue.m_mutex };
+            queue.m_tasks.push_front(std::move(task));
+        }
+        m_wakeup.notify_one();
+    }
+
+    // Schedules `func` and returns a future delivered with its result (or the exception it threw).
+    template <class Func>
+    future_t async(Func func)
+    {
+        future_t result = {};
+        submit(
+            [result, func = std::move(func)]() mutable
+            {
+                try
+                {
+                    result.deliver(func());
+                }
+                catch (...)
+                {
+                    result.fail(std::current_exception());
+                }
+            });
+        return result;
+    }
+
+    // Runs one queued task on the calling thread, if any is available.
+    bool run_pending_task()
+    {
+        task_type task = {};
+        if (!try_pop(current_worker().value_or(0), task))
+        {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+    // Blocks until `future` is ready. Workers of this pool execute pending tasks while waiting.
+    void wait(const future_t& future)
+    {
+        if (!current_worker())
+        {
+            future.wait();
+            return;
+        }
+        while (!future.is_ready())
+        {
+            if (!run_pending_task())
+            {
+                future.wait_for(std::chrono::milliseconds{ 1 });
+            }
+        }
+    }
+
+    value_t deref(const future_t& future)
+    {
+        wait(future);
+        return future.deref();
+    }
+
+    static std::size_t default_size()
+    {
+        const std::size_t configured = configured_size();
+        return configured != 0 ? configured : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // Sets the number of workers of the shared pool; must be called before the pool is first used.
+    static void set_default_size(std::size_t size)
+    {
+        std::lock_guard<std::mutex> lock{ default_mutex() };
+        if (default_started())
+        {
+            throw std::logic_error{ "default thread pool is already running" };
+        }
+        configured_size() = size;
+    }
+
+    static thread_pool& default_pool()
+    {
+        static thread_pool& instance = []() -> thread_pool&
+        {
+            std::lock_guard<std::mutex> lock{ default_mutex() };
+            default_started() = true;
+            // Intentionally leaked: workers may still be referenced by detached futures during static destruction.
+            return *new thread_pool{ default_size() };
+        }();
+        return instance;
+    }
+
+private:
+    struct queue_t
+    {
+        std::mutex m_mutex;
+        std::deque<task_type> m_tasks;
+    };
+
+    std::vector<std::unique_ptr<queue_t>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::atomic<std::size_t> m_next = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::size_t m_pending = 0;
+    bool m_stop = false;
+
+    struct worker_context
+    {
+        const thread_pool* pool = nullptr;
+        std::size_t index = 0;
+    };
+
+    static worker_context& context()
+    {
+        static thread_local worker_context instance = {};
+        return instance;
+    }
+
+    std::optional<std::size_t> current_worker() const
+    {
+        const worker_context& ctx = context();
+        return ctx.pool == this ? std::optional<std::size_t>{ ctx.index } : std::optional<std::size_t>{};
+    }
+
+    static std::size_t& configured_size()
+    {
+        static std::size_t instance = 0;
+        return instance;
+    }
+
+    static bool& default_started()
+    {
+        static bool instance = false;
+        return instance;
+    }
+
+    static std::mutex& default_mutex()
+    {
+        static std::mutex instance;
+        return instance;
+    }
+
+    bool try_pop(std::size_t index, task_type& task)
+    {
+        for (std::size_t n = 0; n < m_queues.size(); ++n)
+        {
+            queue_t& queue = *m_queues[(index + n) % m_queues.size()];
+            std::lock_guard<std::mutex> lock{ queue.m_mutex };
+            if (queue.m_tasks.empty())
+            {
+                continue;
+            }
+            if (n == 0)
+            {
+                task = std::move(queue.m_tasks.front());
+                queue.m_tasks.pop_front();
+            }
+            else
+            {
+                task = std::move(queue.m_tasks.back());
+                queue.m_tasks.pop_back();
+            }
+            std::lock_guard<std::mutex> pending_lock{ m_mutex };
+            --m_pending;
+            return true;
+        }
+        return false;
+    }
+
+    void worker_loop(std::size_t index)
+    {
+        context() = worker_context{ this, index };
+        while (true)
+        {
+            task_type task = {};
+            if (try_pop(index, task))
+            {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            m_wakeup.wait(lock, [this]() { return m_stop || m_pending > 0; });
+            if (m_stop && m_pending == 0)
+            {
+                return;
+            }
+        }
+    }
+};
+
+}  // namespace edn
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <edn/diff.hpp>
+#include <edn/edn.hpp>
+#include <edn/shared_document.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace edn
+{
+
+struct watch_options_t
+{
+    // Quiet period after the last change before the file is read, so that a burst of writes causes one reload.
+    std::chrono::milliseconds debounce = std::chrono::milliseconds{ 50 };
+    // Interval between modification time checks where inotify is not available.
+    std::chrono::milliseconds poll_interval = std::chrono::milliseconds{ 250 };
+    // Called on the watcher thread when the file cannot be read or parsed; the previous value stays current.
+    std::function<void(const std::exception&)> on_error = {};
+};
+
+namespace detail
+{
+
+// Reads the whole file with a single read sized by the file size (plus whatever was appended meanwhile). The file is
+// not mapped: a writer truncating it while it is parsed would fault the mapping.
+inline std::string read_watched_file(const std::filesystem::path& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    if (!file)
+    {
+        throw std::runtime_error{ str("watch: cannot open '", path.string(), "'") };
+    }
+    std::error_code error;
+    const std::uintmax_t size = std::filesystem::file_size(path, error);
+    std::string text(error ? 0 : static_cast<std::size_t>(size), '\0');
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+    text.resize(static_cast<std::size_t>(file.gcount()));
+    text.append(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+    return text;
+}
+
+}  // namespace detail
+
+// Watches a file on a background thread and reports each new version of its content. The file is read once on
+// start; afterwards every burst of changes (including replacement by rename, as editors do) is followed by a reload
+// once the file has been quiet for `debounce`. The new value is diffed against the previous one and the callback runs
+// only if something changed, with the edit script. Uses inotify on Linux and modification time polling elsewhere.
+class file_watcher
+{
+public:
+    using callback_type = std::function<void(const value_t& value, const edit_script_t& edits)>;
+
+    file_watcher(std::filesystem::path path, callback_type callback, watch_options_t options = {})
+        : m_path(std::filesystem::absolute(std::move(path)))
+        , m_callback(std::move(callback))
+        , m_options(std::move(options))
+    {
+        open();
+        m_thread = std::thread{ [this]() { run(); } };
+    }
+
+    file_watcher(const file_watcher&) = delete;
+    file_watcher& operator=(const file_watcher&) = delete;
+
+    ~file_watcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_stop = true;
+        }
+        m_wakeup.notify_all();
+#if defined(__linux__)
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const auto written = ::write(m_stop_fd, &one, sizeof(one));
+#endif
+        m_thread.join();
+#if defined(__linux__)
+        ::close(m_inotify_fd);
+        ::close(m_stop_fd);
+#endif
+    }
+
+    const std::filesystem::path& path() const { return m_path; }
+
+    // Number of reloads that published a changed value, the initial load included.
+    std::size_t reloads() const { return m_reloads; }
+
+private:
+    std::filesystem::path m_path;
+    callback_type m_callback;
+    watch_options_t m_options;
+    std::optional<value_t> m_current;
+    std::atomic<std::size_t> m_reloads = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_stop = false;
+    std::thread m_thread;
+
+#if defined(__linux__)
+    int m_inotify_fd = -1;
+    int m_stop_fd = -1;
+
+    // The directory is watched rather than the file, so that the watch survives the file being replaced.
+    void open()
+    {
+        m_inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        m_stop_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_inotify_fd < 0 || m_stop_fd < 0
+            || ::inotify_add_watch(
+                   m_inotify_fd,
+                   m_path.parent_path().c_str(),
+                   IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE | IN_DELETE)
+                   < 0)
+        {
+            const std::string error = std::strerror(errno);
+            ::close(m_inotify_fd);
+            ::close(m_stop_fd);
+            throw std::runtime_error{ str("watch: cannot watch '", m_path.string(), "': ", error) };
+        }
+    }
+
+    // Consumes pending events and tells whether one of them concerns the watched file.
+    bool drain_events()
+    {
+        alignas(inotify_event) char buffer[4096];
+        bool relevant = false;
+        while (true)
+        {
+            const ssize_t n = ::read(m_inotify_fd, buffer, sizeof(buffer));
+            if (n <= 0)
+            {
+                return relevant;
+            }
+            for (ssize_t offset = 0; offset < n;)
+            {
+                inotify_event event = {};
+                std::memcpy(&event, buffer + offset, sizeof(event));
+                const char* const name = buffer + offset + static_cast<ssize_t>(sizeof(event));
+                relevant = relevant || (event.len > 0 && m_path.filename() == name);
+                offset += static_cast<ssize_t>(sizeof(event) + event.len);
+            }
+        }
+    }
+
+    void run()
+    {
+        reload();
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        while (true)
+        {
+            int timeout = -1;
+            if (deadline)
+            {
+                const auto remaining
+                    = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+                timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+            }
+            pollfd fds[2] = { { m_inotify_fd, POLLIN, 0 }, { m_stop_fd, POLLIN, 0 } };
+            const int ready = ::poll(fds, 2, timeout);
+            if (ready < 0 && errno != EINTR)
+            {
+                return;
+            }
+            if (fds[1].revents & POLLIN)
+            {
+                return;
+            }
+            if ((fds[0].revents & POLLIN) && drain_events())
+            {
+                deadline = std::chrono::steady_clock::now() + m_options.debounce;
+            }
+            else if (deadline && std::chrono::steady_clock::now() >= *deadline)
+            {
+                deadline.reset();
+                reload();
+            }
+        }
+    }
+#else
+    void open() { }
+
+    std::optional<std::filesystem::file_time_type> modification_time() const
+    {
+        std::error_code error;
+        const auto result = std::filesystem::last_write_time(m_path, error);
+        return error ? std::nullopt : std::optional{ result };
+    }
+
+    void run()
+    {
+        std::optional<std::filesystem::file_time_type> seen = modification_time();
+        reload();
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        while (!m_wakeup.wait_for(lock, m_options.poll_interval, [this]() { return m_stop; }))
+        {
+            const auto now = modification_time();
+            if (now == seen)
+            {
+                continue;
+            }
+            // Wait until the file stops changing.
+            seen = now;
+            while (!m_wakeup.wait_for(lock, m_options.debounce, [this]() { return m_stop; }))
+            {
+                const auto later = modification_time();
+                if (later == seen)
+                {
+                    break;
+                }
+                seen = later;
+            }
+            if (m_stop)
+            {
+                return;
+            }
+            lock.unlock();
+            reload();
+            lock.lock();
+        }
+    }
+#endif
+
+    void reload()
+    {
+        value_t next = {};
+        try
+        {
+            next = parse(detail::read_watched_file(m_path));
+        }
+        catch (const std::exception& error)
+        {
+            if (m_options.on_error)
+            {
+                m_options.on_error(error);
+            }
+            return;
+        }
+        const edit_script_t edits
+            = m_current ? diff(*m_current, next) : edit_script_t{ edit_t{ edit_kind_t::replace, {}, next } };
+        if (edits.empty())
+        {
+            return;
+        }
+        m_current = std::move(next);
+        ++m_reloads;
+        m_callback(*m_current, edits);
+    }
+};
+
+// Starts watching `path`; see file_watcher.
+inline std::unique_ptr<file_watcher> watch(
+    std::filesystem::path path, file_watcher::callback_type callback, watch_options_t options = {})
+{
+    return std::make_unique<file_watcher>(std::move(path), std::move(callback), std::move(options));
+}
+
+// Keeps `document` up to date with the content of `path`, publishing only versions that differ.
+inline std::unique_ptr<file_watcher> watch(
+    std::filesystem::path path, shared_document& document, watch_options_t options = {})
+{
+    return watch(
+        std::move(path),
+        [&document](const value_t& value, const edit_script_t&) { document.publish(value); },
+        std::move(options));
+}
+
+}  // namespace edn
@@ -0,0 +1,563 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace edn
+{
+
+struct writer_options_t
+{
+    // Puts every element of a collection on a line of its own, indented by `indent_size` per level.
+    bool pretty = false;
+    int indent_size = 2;
+    // Output is collected up to this many bytes before it is written to the stream.
+    std::size_t buffer_size = 64 * 1024;
+};
+
+namespace detail
+{
+
+[[noreturn]] inline void writer_error(std::string_view message)
+{
+    throw std::runtime_error{ str("writer: ", message) };
+}
+
+// Appends EDN text to a string: scalars formatted in place, and whole values in the compact or pretty layout.
+class edn_formatter_t
+{
+public:
+    edn_formatter_t(std::string& out, const writer_options_t& options) : m_out(out), m_options(options) { }
+
+    void write_indent(std::size_t level)
+    {
+        m_out += '\n';
+        m_out.append(level * static_cast<std::size_t>(std::max(m_options.indent_size, 0)), ' ');
+    }
+
+    void write_symbolic(char prefix, std::string_view name)
+    {
+        if (name.empty())
+        {
+            writer_error("empty name");
+        }
+        if (prefix)
+        {
+            m_out += prefix;
+        }
+        m_out += name;
+    }
+
+    template <class T>
+    void write_number(T number)
+    {
+        char buffer[32];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+        m_out.append(buffer, result.ptr);
+    }
+
+    void write_double(double number)
+    {
+        if (!std::isfinite(number))
+        {
+            writer_error(str("cannot write ", number));
+        }
+        const std::size_t start = m_out.size();
+        write_number(number);
+        // Keep it a floating point number when read back.
+        if (m_out.find_first_of(".eE", start) == std::string::npos)
+        {
+            m_out += ".0";
+        }
+    }
+
+    void write_character(char item)
+    {
+        for (const auto& [ch, text] : detail::character_names())
+        {
+            if (ch == item)
+            {
+                m_out += '\\';
+                m_out += text;
+                return;
+            }
+        }
+        m_out += '\\';
+        m_out += item;
+    }
+
+    void write_string(std::string_view text)
+    {
+        m_out += '"';
+        std::size_t run = 0;  // start of the pending run of characters that need no escaping
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            const char c = text[i];
+            if (c != '"' && c != '\\' && c != '\n' && c != '\r' && c != '\t')
+            {
+                continue;
+            }
+            m_out.append(text.data() + run, i - run);
+            run = i + 1;
+            m_out += '\\';
+            switch (c)
+            {
+                case '\n': m_out += 'n'; break;
+                case '\r': m_out += 'r'; break;
+                case '\t': m_out += 't'; break;
+                default: m_out += c; break;
+            }
+        }
+        m_out.append(text.data() + run, text.size() - run);
+        m_out += '"';
+    }
+
+    // Writes `item` as an element at nesting level `level`, which sets the indentation of a pretty layout.
+    void write(const value_t& item, std::size_t level)
+    {
+        switch (item.type())
+        {
+            case value_type_t::nil: m_out += "nil"; return;
+            case value_type_t::boolean: m_out += *item.if_boolean() ? "true" : "false"; return;
+            case value_type_t::integer: write_number(*item.if_integer()); return;
+            case value_type_t::floating_point: write_double(*item.if_floating_point()); return;
+            case value_type_t::character: write_character(*item.if_character()); return;
+            case value_type_t::string: write_string(*item.if_string()); return;
+            case value_type_t::symbol: m_out += *item.if_symbol(); return;
+            case value_type_t::keyword: write_symbolic(':', *item.if_keyword()); return;
+            case value_type_t::vector: write_sequence("[", *item.if_vector(), ']', level); return;
+            case value_type_t::list: write_sequence("(", *item.if_list(), ')', level); return;
+            case value_type_t::set: write_sequence("#{", *item.if_set(), '}', level); return;
+            case value_type_t::sorted_set: write_sequence("#{", *item.if_sorted_set(), '}', level); return;
+            case value_type_t::map: write_entries(*item.if_map(), level); return;
+            case value_type_t::sorted_map: write_entries(*item.if_sorted_map(), level); return;
+            case value_type_t::tagged_element:
+                m_out += '#';
+                m_out += item.if_tagged_element()->tag();
+                m_out += ' ';
+                write(item.if_tagged_element()->element(), level);
+                return;
+            case value_type_t::quoted_element:
+                m_out += '\'';
+                write(item.if_quoted_element()->element(), level);
+                return;
+            default: writer_error(str("cannot write ", item.type()));
+        }
+    }
+
+    void write_entry(const value_t& key, const value_t& value, std::size_t level)
+    {
+        write(key, level);
+        m_out += ' ';
+        write(value, level);
+    }
+
+private:
+    std::string& m_out;
+    const writer_options_t& m_options;
+
+    template <class Sequence>
+    void write_sequence(std::string_view open, const Sequence& items, char close, std::size_t level)
+    {
+        m_out += open;
+        bool first = true;
+        for (const value_t& element : items)
+        {
+            if (m_options.pretty)
+            {
+                write_indent(level + 1);
+            }
+            else if (!first)
+            {
+                m_out += ' ';
+            }
+            first = false;
+            write(element, level + 1);
+        }
+        if (m_options.pretty && !first)
+        {
+            write_indent(level);
+        }
+        m_out += close;
+    }
+
+    template <class Map>
+    void write_entries(const Map& items, std::size_t level)
+    {
+        m_out += '{';
+        bool first = true;
+        for (const auto& [k, v] : items)
+        {
+            if (m_options.pretty)
+            {
+                write_indent(level + 1);
+            }
+            else if (!first)
+            {
+                m_out += ' ';
+            }
+            first = false;
+            write_entry(k, v, level + 1);
+        }
+        if (m_options.pretty && !first)
+        {
+            write_indent(level);
+        }
+        m_out += '}';
+    }
+};
+
+}  // namespace detail
+
+// Push-style writer of EDN text, for output too large to build as a value_t first. Collections are opened and
+// closed with begin_*() and end_*(), map entries are written as key() followed by one value, and any number of
+// top-level values are written one per line. Every call is checked against the structure written so far and
+// throws std::runtime_error when it would produce invalid EDN (a value where a map key is expected, an unbalanced
+// end, a key without a value). Scalars are formatted straight into the buffer; the only allocations are the buffer
+// itself and the nesting stack, which grows with the deepest nesting.
+//
+//     writer.begin_map().key("id").value(42).key("tags").begin_vector().keyword("a").end_vector().end_map();
+class stream_writer
+{
+public:
+    explicit stream_writer(std::ostream& os, writer_options_t options = {})
+        : m_os(&os)
+        , m_options(options)
+        , m_buffer(m_own)
+        , m_format(m_buffer, m_options)
+    {
+        m_buffer.reserve(m_options.buffer_size + 256);
+        m_stack.reserve(32);
+    }
+
+    // Appends to `out` instead of a stream; flush() does nothing.
+    explicit stream_writer(std::string& out, writer_options_t options = {})
+        : m_os(nullptr)
+        , m_options(options)
+        , m_buffer(out)
+        , m_format(m_buffer, m_options)
+    {
+        m_stack.reserve(32);
+    }
+
+    stream_writer(const stream_writer&) = delete;
+    stream_writer& operator=(const stream_writer&) = delete;
+
+    ~stream_writer()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const std::exception&)
+        {
+        }
+    }
+
+    // True when every collection has been closed and no key or prefix waits for its value.
+    bool complete() const { return m_stack.empty() && !m_prefix; }
+
+    // Nesting level of the collection being written, 0 at the top level.
+    std::size_t depth() const { return m_stack.size(); }
+
+    stream_writer& begin_vector() { return open(frame_type_t::vector, "["); }
+    stream_writer& end_vector() { return close(frame_type_t::vector, ']'); }
+    stream_writer& begin_list() { return open(frame_type_t::list, "("); }
+    stream_writer& end_list() { return close(frame_type_t::list, ')'); }
+    stream_writer& begin_set() { return open(frame_type_t::set, "#{"); }
+    stream_writer& end_set() { return close(frame_type_t::set, '}'); }
+    stream_writer& begin_map() { return open(frame_type_t::map, "{"); }
+    stream_writer& end_map() { return close(frame_type_t::map, '}'); }
+
+    // Writes a map key: a keyword from a bare name, or any value.
+    stream_writer& key(std::string_view name)
+    {
+        begin_key();
+        m_format.write_symbolic(':', name);
+        return end_key();
+    }
+
+    stream_writer& key(const char* name) { return key(std::string_view{ name }); }
+
+    stream_writer& key(const std::string& name) { return key(std::string_view{ name }); }
+
+    stream_writer& key(const value_t& item)
+    {
+        begin_key();
+        m_format.write(item, m_stack.size());
+        return end_key();
+    }
+
+    // Prefixes the next value with the tag `#name` or a quote.
+    stream_writer& tag(std::string_view name)
+    {
+        begin_prefix();
+        m_format.write_symbolic('#', name);
+        m_buffer += ' ';
+        return *this;
+    }
+
+    stream_writer& quote()
+    {
+        begin_prefix();
+        m_buffer += '\'';
+        return *this;
+    }
+
+    stream_writer& value(nil_t)
+    {
+        begin_value();
+        m_buffer += "nil";
+        return end_value();
+    }
+
+    stream_writer& value(bool item)
+    {
+        begin_value();
+        m_buffer += item ? "true" : "false";
+        return end_value();
+    }
+
+    stream_writer& value(char item)
+    {
+        begin_value();
+        m_format.write_character(item);
+        return end_value();
+    }
+
+    template <class T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    stream_writer& value(T item)
+    {
+        begin_value();
+        m_format.write_number(item);
+        return end_value();
+    }
+
+    stream_writer& value(double item)
+    {
+        begin_value();
+        m_format.write_double(item);
+        return end_value();
+    }
+
+    stream_writer& value(std::string_view text)
+    {
+        begin_value();
+        m_format.write_string(text);
+        return end_value();
+    }
+
+    stream_writer& value(const char* text) { return value(std::string_view{ text }); }
+
+    stream_writer& value(const std::string& text) { return value(std::string_view{ text }); }
+
+    stream_writer& value(const keyword_t& name) { return keyword(name); }
+
+    stream_writer& value(const symbol_t& name) { return symbol(name); }
+
+    stream_writer& value(const value_t& item)
+    {
+        begin_value();
+        m_format.write(item, m_stack.size());
+        return end_value();
+    }
+
+    stream_writer& keyword(std::string_view name)
+    {
+        begin_value();
+        m_format.write_symbolic(':', name);
+        return end_value();
+    }
+
+    stream_writer& symbol(std::string_view name)
+    {
+        begin_value();
+        m_format.write_symbolic(0, name);
+        return end_value();
+    }
+
+    // Writes the buffered output to the stream.
+    void flush()
+    {
+        if (m_os)
+        {
+            m_os->write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+            m_os->flush();
+        }
+    }
+
+private:
+    enum class frame_type_t
+    {
+        vector,
+        list,
+        set,
+        map
+    };
+
+    struct frame_t
+    {
+        frame_type_t type;
+        std::size_t count;
+        bool has_key;
+    };
+
+    std::ostream* m_os;
+    writer_options_t m_options;
+    std::string m_own;
+    std::string& m_buffer;
+    detail::edn_formatter_t m_format;
+    std::vector<frame_t> m_stack;
+    bool m_prefix = false;
+
+    static const char* name(frame_type_t type)
+    {
+        switch (type)
+        {
+            case frame_type_t::vector: return "vector";
+            case frame_type_t::list: return "list";
+            case frame_type_t::set: return "set";
+            case frame_type_t::map: return "map";
+        }
+        return "";
+    }
+
+    [[noreturn]] static void fail(std::string_view message) { detail::writer_error(message); }
+
+    bool expects_key() const
+    {
+        return !m_stack.empty() && m_stack.back().type == frame_type_t::map && !m_stack.back().has_key;
+    }
+
+    // Writes the separator in front of a new element of the current collection.
+    void separate()
+    {
+        if (m_stack.empty())
+        {
+            return;
+        }
+        if (m_options.pretty)
+        {
+            m_format.write_indent(m_stack.size());
+        }
+        else if (m_stack.back().count > 0)
+        {
+            m_buffer += ' ';
+        }
+    }
+
+    void begin_key()
+    {
+        if (!expects_key() || m_prefix)
+        {
+            fail("a key is only allowed where a map expects one");
+        }
+        separate();
+    }
+
+    stream_writer& end_key()
+    {
+        m_stack.back().has_key = true;
+        return *this;
+    }
+
+    void begin_prefix()
+    {
+        if (expects_key())
+        {
+            fail("a map key is expected");
+        }
+        if (!m_prefix)
+        {
+            begin_element();
+        }
+        m_prefix = true;
+    }
+
+    void begin_element()
+    {
+        if (!m_stack.empty() && m_stack.back().type == frame_type_t::map)
+        {
+            m_buffer += ' ';
+        }
+        else
+        {
+            separate();
+        }
+    }
+
+    void begin_value()
+    {
+        if (expects_key())
+        {
+            fail("a map key is expected");
+        }
+        if (!m_prefix)
+        {
+            begin_element();
+        }
+        m_prefix = false;
+    }
+
+    stream_writer& end_value()
+    {
+        if (m_stack.empty())
+        {
+            m_buffer += '\n';
+        }
+        else
+        {
+            frame_t& frame = m_stack.back();
+            frame.has_key = false;
+            ++frame.count;
+        }
+        if (m_os && m_buffer.size() >= m_options.buffer_size)
+        {
+            flush();
+        }
+        return *this;
+    }
+
+    stream_writer& open(frame_type_t type, std::string_view bracket)
+    {
+        begin_value();
+        m_buffer += bracket;
+        m_stack.push_back(frame_t{ type, 0, false });
+        return *this;
+    }
+
+    stream_writer& close(frame_type_t type, char bracket)
+    {
+        if (m_stack.empty() || m_stack.back().type != type)
+        {
+            fail(str("end of ", name(type), " without its beginning"));
+        }
+        if (m_prefix)
+        {
+            fail("a tag or quote is not followed by a value");
+        }
+        if (m_stack.back().has_key)
+        {
+            fail("a map key is not followed by a value");
+        }
+        const bool empty = m_stack.back().count == 0;
+        m_stack.pop_back();
+        if (m_options.pretty && !empty)
+        {
+            m_format.write_indent(m_stack.size());
+        }
+        m_buffer += bracket;
+        return end_value();
+    }
+};
+
+}  // namespace edn
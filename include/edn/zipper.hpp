@@ -0,0 +1,278 @@
+#pragma once
+
+#include <edn/edn.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace edn
+{
+
+// Cursor over a value tree for navigation and local edits. Descending moves the focused child out of its parent
+// (leaving nil in its slot) and pushes the parent on the path; ascending moves the child back. Nothing is copied, so
+// an edit of a single leaf costs O(depth) regardless of the size of the tree. Vectors, lists and maps (through their
+// values, in insertion order) can be descended into.
+class zipper_t
+{
+public:
+    explicit zipper_t(value_t root) : m_focus{ std::move(root) } { }
+
+    const value_t& node() const { return m_focus; }
+
+    std::size_t depth() const { return m_path.size(); }
+
+    bool is_top() const { return m_path.empty(); }
+
+    // Position of the focus among its siblings.
+    std::size_t index() const
+    {
+        require_parent("index");
+        return m_path.back().m_index;
+    }
+
+    // Key of the focused entry when the parent is a map, null otherwise.
+    const value_t* key() const
+    {
+        if (m_path.empty())
+        {
+            return nullptr;
+        }
+        const frame_t& frame = m_path.back();
+        if (const auto maybe_map = frame.m_parent.if_map())
+        {
+            return &maybe_map->m_items[frame.m_index].first;
+        }
+        return nullptr;
+    }
+
+    bool is_branch() const { return m_focus.if_vector() || m_focus.if_list() || m_focus.if_map(); }
+
+    std::size_t child_count() const { return children_count(m_focus); }
+
+    zipper_t& down(std::size_t index = 0)
+    {
+        if (!is_branch())
+        {
+            throw std::runtime_error{ str("zipper: cannot descend into ", m_focus.type()) };
+        }
+        if (index >= child_count())
+        {
+            throw std::out_of_range{ str("zipper: child index ", index, " out of range for ", child_count(), " children") };
+        }
+        m_path.push_back(frame_t{ std::move(m_focus), index });
+        m_focus = std::exchange(slot(m_path.back()), value_t{});
+        return *this;
+    }
+
+    // Descends into the value stored under `key` of the focused map.
+    zipper_t& down(const value_t& key)
+    {
+        const auto maybe_map = m_focus.if_map();
+        if (!maybe_map)
+        {
+            throw std::runtime_error{ str("zipper: expected map, got ", m_focus.type()) };
+        }
+        const auto it = maybe_map->find(key);
+        if (it == maybe_map->end())
+        {
+            throw std::out_of_range{ str("zipper: key not found: ", key) };
+        }
+        return down(static_cast<std::size_t>(it - maybe_map->begin()));
+    }
+
+    zipper_t& up()
+    {
+        require_parent("up");
+        frame_t frame = std::move(m_path.back());
+        m_path.pop_back();
+        slot(frame) = std::move(m_focus);
+        m_focus = std::move(frame.m_parent);
+        return *this;
+    }
+
+    zipper_t& top()
+    {
+        while (!m_path.empty())
+        {
+            up();
+        }
+        return *this;
+    }
+
+    zipper_t& left()
+    {
+        require_parent("left");
+        if (m_path.back().m_index == 0)
+        {
+            throw std::out_of_range{ "zipper: no left sibling" };
+        }
+        return move_to(m_path.back().m_index - 1);
+    }
+
+    zipper_t& right()
+    {
+        require_parent("right");
+        if (m_path.back().m_index + 1 >= children_count(m_path.back().m_parent))
+        {
+            throw std::out_of_range{ "zipper: no right sibling" };
+        }
+        return move_to(m_path.back().m_index + 1);
+    }
+
+    bool has_left() const { return !m_path.empty() && m_path.back().m_index > 0; }
+
+    bool has_right() const
+    {
+        return !m_path.empty() && m_path.back().m_index + 1 < children_count(m_path.back().m_parent);
+    }
+
+    zipper_t& replace(value_t value)
+    {
+        m_focus = std::move(value);
+        return *this;
+    }
+
+    // Replaces the focus with `func(node)`; the node is passed as an rvalue so that it can be updated without copying.
+    template <class Func>
+    zipper_t& edit(Func&& func)
+    {
+        m_focus = std::forward<Func>(func)(std::move(m_focus));
+        return *this;
+    }
+
+    // Inserts a sibling before the focus; the parent must be a vector or a list.
+    zipper_t& insert_left(value_t value)
+    {
+        frame_t& frame = require_sequence_parent("insert_left");
+        std::vector<value_t>& items = sequence(frame.m_parent);
+        items.insert(items.begin() + static_cast<std::ptrdiff_t>(frame.m_index), std::move(value));
+        frame.m_index += 1;
+        return *this;
+    }
+
+    // Inserts a sibling after the focus; the parent must be a vector or a list.
+    zipper_t& insert_right(value_t value)
+    {
+        frame_t& frame = require_sequence_parent("insert_right");
+        std::vector<value_t>& items = sequence(frame.m_parent);
+        items.insert(items.begin() + static_cast<std::ptrdiff_t>(frame.m_index + 1), std::move(value));
+        return *this;
+    }
+
+    // Appends a child to the focused vector or list.
+    zipper_t& append_child(value_t value)
+    {
+        if (!m_focus.if_vector() && !m_focus.if_list())
+        {
+            throw std::runtime_error{ str("zipper: cannot append a child to ", m_focus.type()) };
+        }
+        sequence(m_focus).push_back(std::move(value));
+        return *this;
+    }
+
+    // Adds or replaces an entry of the focused map.
+    zipper_t& assoc(const value_t& key, value_t value)
+    {
+        map_t* maybe_map = m_focus.if_mutable<map_t>();
+        if (!maybe_map)
+        {
+            throw std::runtime_error{ str("zipper: expected map, got ", m_focus.type()) };
+        }
+        (*maybe_map)[key] = std::move(value);
+        return *this;
+    }
+
+    // Removes the focus from its vector or list parent and focuses the parent.
+    zipper_t& remove()
+    {
+        frame_t& frame = require_sequence_parent("remove");
+        std::vector<value_t>& items = sequence(frame.m_parent);
+        items.erase(items.begin() + static_cast<std::ptrdiff_t>(frame.m_index));
+        m_focus = std::move(frame.m_parent);
+        m_path.pop_back();
+        return *this;
+    }
+
+    // Moves back to the root, reattaching every node on the path, and returns the edited tree.
+    value_t commit() &&
+    {
+        top();
+        return std::move(m_focus);
+    }
+
+private:
+    struct frame_t
+    {
+        value_t m_parent;
+        std::size_t m_index;
+    };
+
+    value_t m_focus;
+    std::vector<frame_t> m_path;
+
+    static std::size_t children_count(const value_t& value)
+    {
+        if (const auto maybe_vector = value.if_vector())
+        {
+            return maybe_vector->size();
+        }
+        if (const auto maybe_list = value.if_list())
+        {
+            return maybe_list->size();
+        }
+        if (const auto maybe_map = value.if_map())
+        {
+            return maybe_map->size();
+        }
+        return 0;
+    }
+
+    static std::vector<value_t>& sequence(value_t& value)
+    {
+        if (vector_t* maybe_vector = value.if_mutable<vector_t>())
+        {
+            return *maybe_vector;
+        }
+        return *value.if_mutable<list_t>();
+    }
+
+    static value_t& slot(frame_t& frame)
+    {
+        if (map_t* maybe_map = frame.m_parent.if_mutable<map_t>())
+        {
+            return maybe_map->m_items[frame.m_index].second;
+        }
+        return sequence(frame.m_parent)[frame.m_index];
+    }
+
+    void require_parent(const char* operation) const
+    {
+        if (m_path.empty())
+        {
+            throw std::logic_error{ str("zipper: ", operation, " at the top of the tree") };
+        }
+    }
+
+    frame_t& require_sequence_parent(const char* operation)
+    {
+        require_parent(operation);
+        frame_t& frame = m_path.back();
+        if (!frame.m_parent.if_vector() && !frame.m_parent.if_list())
+        {
+            throw std::runtime_error{
+                str("zipper: ", operation, " requires a vector or list parent, got ", frame.m_parent.type()) };
+        }
+        return frame;
+    }
+
+    zipper_t& move_to(std::size_t index)
+    {
+        frame_t& frame = m_path.back();
+        slot(frame) = std::move(m_focus);
+        frame.m_index = index;
+        m_focus = std::exchange(slot(frame), value_t{});
+        return *this;
+    }
+};
+
+}  // namespace edn
@@ -0,0 +1,109 @@
+#include <edn/edn.hpp>
+#include <edn/frozen.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Generator behind the edn_embed() CMake function: parses FILE, freezes it and writes NAME.edn.hpp, declaring
+// `const edn::embedded_t& edn::embedded::NAME()`, and NAME.edn.cpp, holding the block as an array of 64-bit words.
+
+constexpr std::string_view usage = "usage: edn-embed FILE NAME OUTPUT_DIRECTORY\n";
+
+inline std::string load_file(const std::filesystem::path& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    if (!file)
+    {
+        throw std::runtime_error{ edn::str("cannot open '", path.string(), "'") };
+    }
+    return std::string(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+}
+
+inline void save_file(const std::filesystem::path& path, const std::string& text)
+{
+    std::ofstream file{ path, std::ios::binary };
+    file << text;
+    if (!file)
+    {
+        throw std::runtime_error{ edn::str("cannot write '", path.string(), "'") };
+    }
+}
+
+inline std::string header(const std::string& name, const std::filesystem::path& source)
+{
+    return edn::str(
+        "// Generated by edn-embed from ", source.filename().string(), ". Do not edit.\n",
+        "#pragma once\n\n",
+        "#include <edn/embed.hpp>\n\n",
+        "namespace edn::embedded\n{\n\n",
+        "const edn::embedded_t& ", name, "();\n\n",
+        "}  // namespace edn::embedded\n");
+}
+
+inline std::string source(const std::string& name, const std::filesystem::path& source, const edn::frozen_t& frozen)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    const std::size_t words = frozen.size() / sizeof(std::uint64_t);
+    std::vector<std::uint64_t> block(words);
+    std::memcpy(block.data(), frozen.data(), frozen.size());
+
+    std::string result = edn::str(
+        "// Generated by edn-embed from ", source.filename().string(), ". Do not edit.\n",
+        "#include \"", name, ".edn.hpp\"\n\n",
+        "#include <cstdint>\n\n",
+        "namespace\n{\n\n",
+        "const std::uint64_t block[", words, "] = {\n");
+    result.reserve(result.size() + words * 21 + 256);
+    for (std::size_t i = 0; i < words; ++i)
+    {
+        result += i % 6 == 0 ? "    0x" : " 0x";
+        for (int shift = 60; shift >= 0; shift -= 4)
+        {
+            result += digits[(block[i] >> shift) & 0xF];
+        }
+        result += i + 1 == words || i % 6 == 5 ? ",\n" : ",";
+    }
+    result += edn::str(
+        "};\n\n",
+        "}  // namespace\n\n",
+        "namespace edn::embedded\n{\n\n",
+        "const edn::embedded_t& ", name, "()\n{\n",
+        "    static const edn::embedded_t instance{ block, sizeof(block) };\n",
+        "    return instance;\n}\n\n",
+        "}  // namespace edn::embedded\n");
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cerr << usage;
+        return 2;
+    }
+    try
+    {
+        const std::filesystem::path input = argv[1];
+        const std::string name = argv[2];
+        const std::filesystem::path directory = argv[3];
+        const std::vector<edn::value_t> values = edn::detail::parse_fn::read_values(load_file(input));
+        if (values.size() != 1)
+        {
+            throw std::runtime_error{ edn::str(input.string(), ": expected one value, found ", values.size()) };
+        }
+        const edn::frozen_t frozen = edn::freeze(values.front());
+        std::filesystem::create_directories(directory);
+        save_file(directory / (name + ".edn.hpp"), header(name, input));
+        save_file(directory / (name + ".edn.cpp"), source(name, input, frozen));
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "edn-embed: " << ex.what() << "\n";
+        return 1;
+    }
+}
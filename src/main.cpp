@@ -1,7 +1,16 @@
+#include <edn/compress.hpp>
 #include <edn/edn.hpp>
+#include <edn/evaluate.hpp>
+#include <edn/frozen.hpp>
+#include <edn/json.hpp>
+#include <edn/thread_pool.hpp>
+#include <deque>
+#include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -17,135 +26,370 @@ inline auto load_file(std::istream& is) -> std::string
     return std::string(std::istreambuf_iterator<char>{ is }, std::istreambuf_iterator<char>{});
 }
 
+// Reads the file with one read sized by its length, falling back to streaming for files of unknown size.
 inline auto load_file(const path_t& path) -> std::string
 {
-    std::ifstream file(path);
+    std::ifstream file(path, std::ios::binary);
     if (!file)
     {
         throw std::runtime_error{ std::string("cannot open '") + path + "'" };
     }
-    return load_file(file);
+    std::error_code error;
+    const std::filesystem::path file_path{ static_cast<const std::string&>(path) };
+    const std::uintmax_t size = std::filesystem::file_size(file_path, error);
+    std::string text(error ? 0 : static_cast<std::size_t>(size), '\0');
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+    text.resize(static_cast<std::size_t>(file.gcount()));
+    return text + load_file(file);
 }
 
-void test_parse(const std::string& input)
+// Compressed input (gzip, zlib or zstd, as far as the build supports them) is decompressed transparently.
+inline auto decompress(std::string text) -> std::string
 {
-    std::cout << "\n=== Parsing: " << input << " ===\n";
-    try
+    if (edn::detect_compression(text) == edn::compression_t::none)
+    {
+        return text;
+    }
+    std::istringstream is{ std::move(text) };
+    edn::decompressing_istream decompressed{ is };
+    return load_file(decompressed);
+}
+
+struct usage_error : public std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+constexpr std::string_view usage = R"(usage: edn [-j N] [--color] COMMAND [ARGS] [FILE...]
+
+Reads every FILE (or standard input, also given as -), decompressing it if needed, and writes the results in input
+order. Files are processed in parallel on N threads (default: one per core). --color highlights the output of fmt.
+
+commands:
+  fmt                        pretty print every value
+  cat                        print every value on one line
+  validate                   check that the inputs parse, reporting errors
+  eval                       evaluate every file as a program and print the result
+  query PATH                 print the value at PATH (e.g. [:users 0 :name]) of every value
+  convert [--from edn|json] --to edn|json|binary
+                             convert every value, to a line of EDN or JSON or to a frozen binary block
+)";
+
+enum class command_t
+{
+    fmt,
+    cat,
+    validate,
+    eval,
+    query,
+    to_json,
+    to_binary
+};
+
+struct options_t
+{
+    command_t command = command_t::cat;
+    std::size_t jobs = edn::thread_pool::default_size();
+    edn::vector_t query_path;
+    bool from_json = false;
+    edn::pretty_print_options pretty = { 2, std::nullopt };
+    std::vector<std::string> inputs;
+};
+
+inline options_t parse_arguments(const std::vector<std::string>& args)
+{
+    options_t result = {};
+    std::size_t i = 1;
+    const auto next = [&](std::string_view what) -> const std::string&
+    {
+        if (i + 1 >= args.size())
+        {
+            throw usage_error{ edn::str("missing ", what) };
+        }
+        return args[++i];
+    };
+    for (; i < args.size() && args[i].size() > 1 && args[i].front() == '-'; ++i)
     {
-        edn::value_t result = edn::parse(input);
-        std::cout << "Success! Result:\n";
-        edn::pretty_print(std::cout, result);
+        if (args[i] == "-j")
+        {
+            result.jobs = std::stoul(next("number of jobs"));
+        }
+        else if (args[i] == "--color")
+        {
+            result.pretty.colors = edn::color_scheme{};
+        }
+        else if (args[i] == "-h" || args[i] == "--help")
+        {
+            throw usage_error{ "" };
+        }
+        else
+        {
+            throw usage_error{ edn::str("unknown option '", args[i], "'") };
+        }
     }
-    catch (const edn::parse_error& e)
+    if (i == args.size())
+    {
+        throw usage_error{ "missing command" };
+    }
+
+    const std::string& command = args[i];
+    if (command == "fmt")
     {
-        std::cout << "Error: " << e.what() << "\n";
+        result.command = command_t::fmt;
     }
+    else if (command == "cat")
+    {
+        result.command = command_t::cat;
+    }
+    else if (command == "validate")
+    {
+        result.command = command_t::validate;
+    }
+    else if (command == "eval")
+    {
+        result.command = command_t::eval;
+    }
+    else if (command == "query")
+    {
+        const edn::value_t path = edn::parse(next("query path"));
+        result.command = command_t::query;
+        result.query_path = path.if_vector() ? *path.if_vector() : edn::vector_t{ path };
+    }
+    else if (command == "convert")
+    {
+        bool has_format = false;
+        while (i + 1 < args.size() && (args[i + 1] == "--from" || args[i + 1] == "--to"))
+        {
+            const bool from = next("") == "--from";
+            const std::string& format = next("format");
+            if (from && (format == "json" || format == "edn"))
+            {
+                result.from_json = format == "json";
+            }
+            else if (!from && format == "json")
+            {
+                result.command = command_t::to_json;
+            }
+            else if (!from && format == "binary")
+            {
+                result.command = command_t::to_binary;
+            }
+            else if (!from && format == "edn")
+            {
+                result.command = command_t::cat;
+            }
+            else
+            {
+                throw usage_error{ edn::str("unknown format '", format, "'") };
+            }
+            has_format = has_format || !from;
+        }
+        if (!has_format)
+        {
+            throw usage_error{ "convert requires --to edn|json|binary" };
+        }
+    }
+    else
+    {
+        throw usage_error{ edn::str("unknown command '", command, "'") };
+    }
+
+    result.inputs.assign(args.begin() + static_cast<std::ptrdiff_t>(i + 1), args.end());
+    if (result.inputs.empty())
+    {
+        result.inputs.push_back("-");
+    }
+    result.jobs = std::max<std::size_t>(std::min(result.jobs, result.inputs.size()), 1);
+    return result;
 }
 
-void demo_parser()
-{
-    std::cout << "EDN Parser with Location-Aware Error Reporting\n";
-    std::cout << "===============================================\n";
-
-    // Valid examples
-    test_parse("42");
-    test_parse("3.14");
-    test_parse("true");
-    test_parse("nil");
-    test_parse(":keyword");
-    test_parse("\"hello world\"");
-    test_parse("\\newline");
-    test_parse("symbol");
-    test_parse("[1 2 3]");
-    test_parse("(+ 1 2)");
-    test_parse("{:name \"John\" :age 30}");
-    test_parse("#{1 2 3}");
-    test_parse("#inst \"2024-01-01\"");
-    test_parse("'(1 2 3)");
-
-    // Complex nested structure
-    test_parse(R"(
-    {:person {:name "Alice"
-              :age 30
-              :hobbies ["reading" "coding"]}
-     :scores [95 87 92]}
-    )");
-
-    test_parse(R"(
-    [{:person {:name "Alice"
-              :age 30
-              :hobbies ["reading" "coding"]}
-     :scores [95 87 92]}
-     {:person {:name "Alice"
-              :age 30
-              :hobbies ["reading" "coding"]}
-     :scores [95 87 92]}]
-    )");
-
-    // Error examples - these will show line numbers
-    test_parse("[1 2 3");                 // Unterminated vector
-    test_parse("{:a 1 :b}");              // Odd number of map elements
-    test_parse("\"unterminated string");  // Unterminated string
-
-    // Multi-line error example
-    test_parse(R"(
-    [1 2 3
-     4 5 6
-     7 8
-    )");  // Unterminated vector on line 4
-
-    // Map error with location
-    test_parse(R"(
-    {:a 1
-     :b 2
-     :c 3
-     :d}
-    )");  // Odd number of elements - error on closing brace
+template <class Sequence>
+const edn::value_t* element_at(const Sequence& items, const edn::value_t& index)
+{
+    const auto i = index.if_integer();
+    return i && *i >= 0 && static_cast<std::size_t>(*i) < items.size() ? &items[static_cast<std::size_t>(*i)] : nullptr;
 }
 
-void run(const std::vector<std::string>&)
-{
-    using namespace edn::literals;
-
-    edn::pretty_print(
-        std::cout,
-        edn::list_t{ "each-item"_kw,
-                     edn::list_t{ "and"_kw,
-                                  edn::list_t{ edn::list_t{ edn::list_t{ "ge"_kw, 5 } },
-                                               edn::list_t{ "lt"_kw, 10 },
-                                               edn::list_t{ "odd?"_kw } } } });
-
-    edn::pretty_print(std::cout, edn::parse(R"(
-        [{
-            :name "John Doe"
-            :age 30
-            :is_student false
-            :scores [95 88 76 89]
-            :address {
-                :street "123 Main St"
-                :city "Anytown"
-                :zip "12345"
+// Value at `path` in `item`: keys for maps, indices for vectors and lists, elements for sets; nil if there is none.
+inline edn::value_t get_in(const edn::value_t& item, const edn::vector_t& path)
+{
+    const edn::value_t* current = &item;
+    for (const edn::value_t& step : path)
+    {
+        const edn::value_t* next = nullptr;
+        if (const auto map = current->if_map())
+        {
+            const auto it = map->find(step);
+            next = it != map->end() ? &it->second : nullptr;
+        }
+        else if (const auto sorted_map = current->if_sorted_map())
+        {
+            const auto it = sorted_map->find(step);
+            next = it != sorted_map->end() ? &it->second : nullptr;
+        }
+        else if (const auto vector = current->if_vector())
+        {
+            next = element_at(*vector, step);
+        }
+        else if (const auto list = current->if_list())
+        {
+            next = element_at(*list, step);
+        }
+        else if (const auto set = current->if_set())
+        {
+            next = set->count(step) > 0 ? &step : nullptr;
+        }
+        if (!next)
+        {
+            return edn::value_t{};
+        }
+        current = next;
+    }
+    return *current;
+}
+
+inline std::vector<edn::value_t> read_values(const options_t& options, const std::string& text)
+{
+    if (!options.from_json)
+    {
+        return edn::detail::parse_fn::read_values(text);
+    }
+    std::vector<edn::value_t> result;
+    std::istringstream is{ text };
+    edn::json_reader reader{ is };
+    while (std::optional<edn::value_t> value = reader.next())
+    {
+        result.push_back(std::move(*value));
+    }
+    return result;
+}
+
+// Output of one input, buffered so that inputs processed in parallel are written in order.
+struct output_t
+{
+    std::string text;
+    std::string errors;
+    bool failed = false;
+};
+
+inline void write_value(const options_t& options, const edn::value_t& value, std::ostream& os)
+{
+    switch (options.command)
+    {
+        case command_t::fmt: edn::pretty_print(os, value, options.pretty); break;
+        case command_t::cat: os << value << "\n"; break;
+        case command_t::query: os << get_in(value, options.query_path) << "\n"; break;
+        case command_t::to_json:
+            edn::write_json(os, value);
+            os << "\n";
+            break;
+        case command_t::to_binary:
+        {
+            const edn::frozen_t frozen = edn::freeze(value);
+            os.write(static_cast<const char*>(frozen.data()), static_cast<std::streamsize>(frozen.size()));
+            break;
+        }
+        case command_t::validate:
+        case command_t::eval: break;
+    }
+}
+
+inline output_t process(const options_t& options, const std::string& input)
+{
+    output_t result = {};
+    std::ostringstream os;
+    try
+    {
+        const std::string text = decompress(input == "-" ? load_file(std::cin) : load_file(path_t{ input }));
+        if (options.command == command_t::eval)
+        {
+            edn::stack_t stack{ nullptr };
+            os << edn::evaluate(edn::parse(text), stack) << "\n";
+        }
+        else
+        {
+            for (const edn::value_t& value : read_values(options, text))
+            {
+                write_value(options, value, os);
             }
-            :hobbies ["reading" "coding" "hiking"]
-        }]
-        )"));
-    edn::pretty_print(
-        std::cout,
-        edn::map_t{ { edn::keyword_t("server"),
-                      edn::map_t{ { edn::keyword_t("host"), "localhost" },
-                                  { edn::keyword_t("port"), 8080 },
-                                  { edn::keyword_t("ssl"), true } } },
-                    { edn::keyword_t("endpoints"), edn::vector_t{ "/api/users", "/api/posts", "/api/comments" } } });
+        }
+    }
+    catch (const std::exception& error)
+    {
+        result.errors = edn::str(input == "-" ? "<stdin>" : input, ": ", error.what(), "\n");
+        result.failed = true;
+    }
+    result.text = os.str();
+    return result;
+}
+
+inline void write(const output_t& output)
+{
+    std::cout.write(output.text.data(), static_cast<std::streamsize>(output.text.size()));
+    std::cerr << output.errors;
+}
+
+// Processes the inputs on `options.jobs` threads, keeping a bounded window of results in flight.
+inline bool run(const options_t& options)
+{
+    bool failed = false;
+    if (options.jobs == 1)
+    {
+        for (const std::string& input : options.inputs)
+        {
+            const output_t output = process(options, input);
+            write(output);
+            failed = failed || output.failed;
+        }
+        return !failed;
+    }
+
+    edn::thread_pool pool{ options.jobs };
+    std::deque<std::future<output_t>> pending;
+    const auto flush = [&]()
+    {
+        const output_t output = pending.front().get();
+        pending.pop_front();
+        write(output);
+        failed = failed || output.failed;
+    };
+    for (const std::string& input : options.inputs)
+    {
+        if (pending.size() >= 2 * options.jobs)
+        {
+            flush();
+        }
+        const auto task = std::make_shared<std::packaged_task<output_t()>>([&options, input]()
+                                                                            { return process(options, input); });
+        pending.push_back(task->get_future());
+        pool.submit([task]() { (*task)(); });
+    }
+    while (!pending.empty())
+    {
+        flush();
+    }
+    return !failed;
 }
 
 int main(int argc, char** argv)
 {
+    std::ios::sync_with_stdio(false);
     try
     {
-        run(std::vector<std::string>(argv, argv + argc));
+        return run(parse_arguments(std::vector<std::string>(argv, argv + argc))) ? 0 : 1;
+    }
+    catch (const usage_error& ex)
+    {
+        if (*ex.what())
+        {
+            std::cerr << "edn: " << ex.what() << "\n\n";
+        }
+        std::cerr << usage;
+        return 2;
     }
     catch (const std::exception& ex)
     {
-        std::cout << "\nError:\n" << ex.what() << "\n";
+        std::cerr << "edn: " << ex.what() << "\n";
+        return 1;
     }
 }
@@ -0,0 +1,45 @@
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <edn/bind.hpp>
+#include <edn/evaluate.hpp>
+
+#include "matchers.hpp"
+
+TEST(bind, converts_arguments_and_result)
+{
+    const edn::callable_t callable
+        = edn::bind(+[](std::int64_t a, double b) -> double { return static_cast<double>(a) * b; });
+    EXPECT_THAT(callable({ 3, 0.5 }), IsFloatingPoint(1.5));
+    EXPECT_THAT(callable({ 3, 2 }), IsFloatingPoint(6.0));
+}
+
+TEST(bind, binds_strings_and_collections_by_reference)
+{
+    const edn::callable_t callable = edn::bind(
+        [](const std::string& prefix, const edn::vector_t& items) { return prefix + std::to_string(items.size()); });
+    EXPECT_THAT(callable({ edn::string_t{ "n=" }, edn::vector_t{ 1, 2, 3 } }), IsString(testing::StrEq("n=3")));
+}
+
+TEST(bind, void_result_is_nil)
+{
+    int calls = 0;
+    const edn::callable_t callable = edn::bind([&](bool) { ++calls; });
+    EXPECT_THAT(callable({ true }), IsNil(true));
+    EXPECT_THAT(calls, 1);
+}
+
+TEST(bind, rejects_wrong_arity_and_types)
+{
+    const edn::callable_t callable = edn::bind([](int a, int b) { return a + b; });
+    EXPECT_THROW(callable({ 1 }), std::runtime_error);
+    EXPECT_THROW(callable({ 1, edn::string_t{ "2" } }), std::runtime_error);
+    EXPECT_THROW(edn::bind([](std::uint8_t v) { return v; })({ 256 }), std::out_of_range);
+}
+
+TEST(bind, bound_function_is_callable_from_evaluator)
+{
+    edn::stack_t stack{ nullptr };
+    stack.insert(edn::symbol_t{ "+" }, edn::bind([](int a, int b) { return a + b; }));
+    EXPECT_THAT(edn::evaluate(edn::parse("(+ 2 (+ 3 4))"), stack), 9);
+}
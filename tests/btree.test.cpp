@@ -0,0 +1,82 @@
+#include <gmock/gmock.h>
+
+#include <edn/btree.hpp>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+
+struct identity
+{
+    int operator()(int v) const { return v; }
+};
+
+struct three_way
+{
+    int operator()(int lhs, int rhs) const { return lhs < rhs ? -1 : rhs < lhs ? 1 : 0; }
+};
+
+using small_tree = edn::detail::btree<int, identity, three_way, 2>;
+
+template <class Range>
+std::vector<int> to_vector(const Range& range)
+{
+    return std::vector<int>(range.begin(), range.end());
+}
+
+}  // namespace
+
+TEST(btree, matches_std_set_under_random_inserts_and_erases)
+{
+    std::mt19937 rng{ 42 };
+    std::uniform_int_distribution<int> dist{ 0, 300 };
+    small_tree tree = {};
+    std::set<int> expected = {};
+    for (int i = 0; i < 5000; ++i)
+    {
+        const int key = dist(rng);
+        if (i % 3 == 2)
+        {
+            EXPECT_EQ(tree.erase(key), expected.erase(key) == 1);
+        }
+        else
+        {
+            EXPECT_EQ(tree.insert_or_assign(key), expected.insert(key).second);
+        }
+    }
+    ASSERT_EQ(tree.size(), expected.size());
+    EXPECT_THAT(to_vector(tree), testing::ElementsAreArray(expected));
+    EXPECT_THAT(
+        std::vector<int>(std::make_reverse_iterator(tree.end()), std::make_reverse_iterator(tree.begin())),
+        testing::ElementsAreArray(expected.rbegin(), expected.rend()));
+
+    const small_tree copy = tree;
+    for (int key = -1; key <= 301; ++key)
+    {
+        EXPECT_EQ(copy.contains(key), expected.count(key) == 1);
+        const auto lower = copy.lower_bound(key);
+        const auto expected_lower = expected.lower_bound(key);
+        EXPECT_EQ(lower == copy.end(), expected_lower == expected.end());
+        if (expected_lower != expected.end())
+        {
+            EXPECT_EQ(*lower, *expected_lower);
+        }
+    }
+}
+
+TEST(btree, subseq_and_rsubseq)
+{
+    small_tree tree = {};
+    for (int i = 1; i <= 10; ++i)
+    {
+        tree.insert_or_assign(i * 10);
+    }
+    EXPECT_THAT(to_vector(tree.subseq(edn::range_test::gt, 80)), testing::ElementsAre(90, 100));
+    EXPECT_THAT(to_vector(tree.subseq(edn::range_test::le, 20)), testing::ElementsAre(10, 20));
+    EXPECT_THAT(
+        to_vector(tree.subseq(edn::range_test::ge, 30, edn::range_test::lt, 60)), testing::ElementsAre(30, 40, 50));
+    EXPECT_THAT(to_vector(tree.rsubseq(edn::range_test::lt, 35)), testing::ElementsAre(30, 20, 10));
+    EXPECT_TRUE(tree.subseq(edn::range_test::gt, 50, edn::range_test::lt, 50).empty());
+}
@@ -0,0 +1,53 @@
+#include <gmock/gmock.h>
+
+#include <edn/canonical.hpp>
+#include <edn/zipper.hpp>
+#include <cmath>
+
+#include "matchers.hpp"
+
+TEST(canonical, sorts_keys_and_normalizes_numbers)
+{
+    EXPECT_EQ(
+        edn::to_canonical_string(edn::parse(R"({:b #{3 1 2}, :a [1.0 -0.0 0.1 2.5e300]   "x" "a\nb"})")),
+        R"({"x" "a\nb" :a [1.0 0.0 0.1 2.5e+300] :b #{1 2 3}})");
+    EXPECT_EQ(edn::to_canonical_string(edn::parse("(f #tag 'x \\a)")), "(f #tag 'x \\a)");
+    EXPECT_THROW(edn::to_canonical_string(edn::atom_t{ 1 }), std::runtime_error);
+}
+
+TEST(canonical, equal_values_have_equal_hashes)
+{
+    const edn::value_t value = edn::parse("{:a [1 2 {:b #{3 \"x\"}}] :c (1.5 nil true)}");
+    const edn::value_t copy = value;
+    EXPECT_EQ(edn::content_hash(value), edn::content_hash(copy));
+    EXPECT_EQ(edn::content_hash(value), edn::content_hash(edn::parse(edn::to_canonical_string(value))));
+    EXPECT_NE(edn::content_hash(edn::vector_t{ 1, 2 }), edn::content_hash(edn::list_t{ 1, 2 }));
+    EXPECT_NE(edn::content_hash(edn::symbol_t{ "a" }), edn::content_hash(edn::keyword_t{ "a" }));
+    EXPECT_NE(edn::content_hash(edn::vector_t{ 1, 2 }), edn::content_hash(edn::vector_t{ 2, 1 }));
+}
+
+TEST(canonical, cached_hash_follows_edits)
+{
+    edn::value_t value = edn::parse("{:servers [{:port 80} {:port 81}]}");
+    const edn::hash128_t before = edn::content_hash(value);
+    edn::zipper_t zipper{ std::move(value) };
+    zipper.down(edn::keyword_t{ "servers" }).down(1).down(edn::keyword_t{ "port" }).replace(82);
+    value = std::move(zipper).commit();
+    EXPECT_NE(edn::content_hash(value), before);
+    EXPECT_EQ(edn::content_hash(value), edn::content_hash(edn::parse("{:servers [{:port 80} {:port 82}]}")));
+}
+
+TEST(canonical, cached_hashes_keep_equality_semantics)
+{
+    const edn::value_t lhs = edn::vector_t{ 1, 2, 3 };
+    const edn::value_t rhs = edn::vector_t{ 1, 2, 4 };
+    edn::content_hash(lhs);
+    edn::content_hash(rhs);
+    EXPECT_NE(lhs, rhs);
+
+    // Floating point values compare with a tolerance, so their hashes never reject equality.
+    const edn::value_t approx_lhs = edn::vector_t{ 0.1 };
+    const edn::value_t approx_rhs = edn::vector_t{ std::nextafter(0.1, 1.0) };
+    EXPECT_NE(edn::content_hash(approx_lhs), edn::content_hash(approx_rhs));
+    EXPECT_EQ(approx_lhs, approx_rhs);
+}
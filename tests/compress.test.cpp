@@ -0,0 +1,126 @@
+#include <gmock/gmock.h>
+
+#include <edn/compress.hpp>
+#include <edn/pipeline.hpp>
+#include <sstream>
+
+namespace
+{
+
+std::string sample_text()
+{
+    std::string result;
+    for (int i = 0; i < 5000; ++i)
+    {
+        result += edn::str("{:id ", i, " :name \"record ", i, "\" :tags [:a :b]}\n");
+    }
+    return result;
+}
+
+std::string compress(const std::string& text, edn::compression_t format)
+{
+    std::ostringstream os;
+    {
+        edn::compressing_ostream compressed{ os, format };
+        compressed << text;
+    }
+    return os.str();
+}
+
+std::string decompress(const std::string& data, std::size_t chunk_size = 64 * 1024)
+{
+    std::istringstream is{ data };
+    edn::decompressing_istream decompressed{ is, chunk_size, 4 };
+    return std::string(std::istreambuf_iterator<char>{ decompressed }, std::istreambuf_iterator<char>{});
+}
+
+void expect_round_trip(edn::compression_t format)
+{
+    if (!edn::compression_available(format))
+    {
+        GTEST_SKIP() << format << " support is not enabled";
+    }
+    const std::string text = sample_text();
+    const std::string data = compress(text, format);
+    EXPECT_LT(data.size(), text.size() / 4);
+    EXPECT_EQ(edn::detect_compression(data), format);
+    EXPECT_EQ(decompress(data), text);
+    EXPECT_EQ(decompress(data, 7), text);
+}
+
+}  // namespace
+
+TEST(compress, gzip_round_trip)
+{
+    expect_round_trip(edn::compression_t::gzip);
+}
+
+TEST(compress, zlib_round_trip)
+{
+    expect_round_trip(edn::compression_t::zlib);
+}
+
+TEST(compress, zstd_round_trip)
+{
+    expect_round_trip(edn::compression_t::zstd);
+}
+
+TEST(compress, plain_input_passes_through)
+{
+    const std::string text = sample_text();
+    std::istringstream is{ text };
+    edn::decompressing_istream decompressed{ is };
+    EXPECT_EQ(decompressed.format(), edn::compression_t::none);
+    EXPECT_EQ(std::string(std::istreambuf_iterator<char>{ decompressed }, std::istreambuf_iterator<char>{}), text);
+}
+
+TEST(compress, reads_concatenated_gzip_members)
+{
+    if (!edn::compression_available(edn::compression_t::gzip))
+    {
+        GTEST_SKIP() << "gzip support is not enabled";
+    }
+    EXPECT_EQ(decompress(compress("[1 2]\n", edn::compression_t::gzip) + compress("[3]\n", edn::compression_t::gzip)),
+              "[1 2]\n[3]\n");
+}
+
+TEST(compress, reports_truncated_data)
+{
+    if (!edn::compression_available(edn::compression_t::gzip))
+    {
+        GTEST_SKIP() << "gzip support is not enabled";
+    }
+    const std::string data = compress(sample_text(), edn::compression_t::gzip);
+    EXPECT_THROW(decompress(data.substr(0, data.size() / 2)), std::runtime_error);
+}
+
+TEST(compress, stops_reading_when_destroyed_early)
+{
+    if (!edn::compression_available(edn::compression_t::gzip))
+    {
+        GTEST_SKIP() << "gzip support is not enabled";
+    }
+    const std::string data = compress(sample_text(), edn::compression_t::gzip);
+    std::istringstream is{ data };
+    edn::decompressing_istream decompressed{ is, 256, 2 };
+    std::string line;
+    std::getline(decompressed, line);
+    EXPECT_EQ(line, "{:id 0 :name \"record 0\" :tags [:a :b]}");
+}
+
+TEST(compress, feeds_pipeline)
+{
+    if (!edn::compression_available(edn::compression_t::gzip))
+    {
+        GTEST_SKIP() << "gzip support is not enabled";
+    }
+    std::istringstream is{ compress(sample_text(), edn::compression_t::gzip) };
+    edn::decompressing_istream input{ is };
+    std::ostringstream os;
+    {
+        edn::compressing_ostream output{ os, edn::compression_t::gzip };
+        const edn::pipeline_statistics statistics = edn::pipeline_t{}.run(input, output);
+        EXPECT_EQ(statistics.stages.back().records_out, 5000);
+    }
+    EXPECT_EQ(decompress(os.str()), sample_text());
+}
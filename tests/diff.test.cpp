@@ -0,0 +1,56 @@
+#include <gmock/gmock.h>
+
+#include <edn/diff.hpp>
+
+#include "matchers.hpp"
+
+namespace
+{
+
+void expect_round_trip(const edn::value_t& before, const edn::value_t& after)
+{
+    EXPECT_EQ(edn::patch(before, edn::diff(before, after)), after) << before << " -> " << after;
+}
+
+}  // namespace
+
+TEST(diff, identical_values_produce_no_edits)
+{
+    const edn::value_t value = edn::parse("{:a [1 2 #{3}] :b (sorted-map 1 2)}");
+    EXPECT_THAT(edn::diff(value, value), testing::IsEmpty());
+}
+
+TEST(diff, reports_changed_leaf_by_path)
+{
+    const edn::value_t before = edn::parse("{:db {:host \"a\" :port 80} :debug false}");
+    const edn::value_t after = edn::parse("{:db {:host \"a\" :port 81} :debug false :name \"x\"}");
+    EXPECT_THAT(
+        edn::diff(before, after),
+        testing::ElementsAre(
+            edn::edit_t{ edn::edit_kind_t::replace, *edn::parse("[:db :port]").if_vector(), 81 },
+            edn::edit_t{ edn::edit_kind_t::add, *edn::parse("[:name]").if_vector(), "x" }));
+}
+
+TEST(diff, patch_reproduces_target)
+{
+    expect_round_trip(edn::parse("[1 2 3 4]"), edn::parse("[1 4]"));
+    expect_round_trip(edn::parse("[1 2 3]"), edn::parse("[1 9 9 3]"));
+    expect_round_trip(edn::parse("(1 [2 3] 4)"), edn::parse("(1 [2 5 3] 4 6)"));
+    expect_round_trip(edn::parse("#{1 2 3}"), edn::parse("#{2 3 4}"));
+    expect_round_trip(edn::parse("{:a 1 :b 2}"), edn::parse("{:b 2 :a 1}"));
+    expect_round_trip(edn::parse("{:a 1 :b {:c [1 2]}}"), edn::parse("{:b {:c [1 3]} :d nil}"));
+    expect_round_trip(edn::parse("[1 2]"), edn::parse("{:a 1}"));
+    expect_round_trip(
+        edn::sorted_map_t{ { 1, edn::vector_t{ 1 } }, { 2, 2 } },
+        edn::sorted_map_t{ { 1, edn::vector_t{ 1, 2 } }, { 3, 3 } });
+    expect_round_trip(edn::sorted_set_t{ 1, 2, 3 }, edn::sorted_set_t{ 0, 3 });
+}
+
+TEST(diff, patch_rejects_invalid_paths)
+{
+    const edn::value_t value = edn::parse("[1 2]");
+    EXPECT_THROW(
+        edn::patch(value, { edn::edit_t{ edn::edit_kind_t::replace, edn::vector_t{ 5 }, 0 } }), std::out_of_range);
+    EXPECT_THROW(
+        edn::patch(value, { edn::edit_t{ edn::edit_kind_t::replace, edn::vector_t{ 0, 0 }, 0 } }), std::runtime_error);
+}
@@ -170,3 +170,58 @@ TEST(edn, map)
             OfType(edn::value_type_t::map),
             WhenSerialized(testing::StrEq(R"({:name "John" :age 30})"))));
 }
+
+TEST(edn, atom)
+{
+    const edn::atom_t atom{ 42 };
+    const edn::value_t value{ atom };
+    EXPECT_THAT(value, testing::AllOf(OfType(edn::value_type_t::atom), WhenSerialized(testing::StrEq("<< atom >>"))));
+    EXPECT_THAT(value.if_atom()->deref(), IsInteger(42));
+
+    atom.reset(7);
+    EXPECT_THAT(value.if_atom()->deref(), IsInteger(7));
+    EXPECT_EQ(value, edn::value_t{ atom });
+    EXPECT_NE(value, edn::value_t{ edn::atom_t{ 7 } });
+}
+
+TEST(edn, vector_builder)
+{
+    edn::vector_builder builder{ 3 };
+    builder.push_back(1).push_back("A").push_back('a');
+    EXPECT_THAT(std::move(builder).build(), WhenSerialized(testing::StrEq(R"([1 "A" \a])")));
+}
+
+TEST(edn, set_builder_sorts_and_deduplicates)
+{
+    edn::set_builder builder = {};
+    builder.insert(3).insert(1).insert(edn::keyword_t{ "k" }).insert(3).insert(2).insert(1);
+    EXPECT_THAT(std::move(builder).build(), testing::AllOf(OfType(edn::value_type_t::set), IsSet(testing::SizeIs(4))));
+}
+
+TEST(edn, map_builder_keeps_first_position_and_last_value)
+{
+    using namespace edn::literals;
+    edn::map_builder builder = {};
+    builder.insert("b"_kw, 1).insert("a"_kw, 2).insert("b"_kw, 3);
+    EXPECT_THAT(std::move(builder).build(), WhenSerialized(testing::StrEq("{:b 3 :a 2}")));
+}
+
+TEST(edn, sorted_map)
+{
+    using namespace edn::literals;
+    const edn::value_t value = edn::sorted_map_t{ { "b"_kw, 2 }, { 3, "x" }, { "a"_kw, 1 } };
+    EXPECT_THAT(
+        value,
+        testing::AllOf(
+            OfType(edn::value_type_t::sorted_map), WhenSerialized(testing::StrEq(R"({3 "x" :a 1 :b 2})"))));
+    EXPECT_THAT(value.if_sorted_map()->at("b"_kw), IsInteger(2));
+    EXPECT_EQ(value, (edn::sorted_map_t{ { 3, "x" }, { "a"_kw, 1 }, { "b"_kw, 2 } }));
+}
+
+TEST(edn, compare_orders_by_type_then_value)
+{
+    EXPECT_LT(edn::compare(1, 2), 0);
+    EXPECT_EQ(edn::compare(edn::vector_t{ 1, 2 }, edn::vector_t{ 1, 2 }), 0);
+    EXPECT_GT(edn::compare(edn::vector_t{ 1, 2 }, edn::vector_t{ 1 }), 0);
+    EXPECT_NE(edn::compare(1, edn::string_t{ "1" }), 0);
+}
@@ -0,0 +1,26 @@
+#include <gmock/gmock.h>
+
+#include "countries.edn.hpp"
+
+TEST(embed, reads_block_compiled_into_program)
+{
+    const edn::embedded_t& countries = edn::embedded::countries();
+    EXPECT_EQ(countries.size() % 8, 0);
+    const edn::frozen_map_t root = *countries.root().if_map();
+    EXPECT_EQ(*root.at(edn::keyword_t{ "version" }).if_integer(), 3);
+    const edn::frozen_sequence_t list = *root.at(edn::keyword_t{ "countries" }).if_vector();
+    ASSERT_EQ(list.size(), 3);
+    EXPECT_EQ(list[2].if_map()->at(edn::keyword_t{ "capital" }).if_string(), "Reykjavík");
+    EXPECT_EQ(&edn::embedded::countries(), &countries);
+}
+
+TEST(embed, thaws_to_parsed_value)
+{
+    EXPECT_EQ(
+        edn::embedded::countries().thaw(),
+        edn::parse(R"({:version 3
+                      :countries [{:code "PL" :name "Poland" :capital "Warsaw" :population 38000000}
+                                  {:code "NO" :name "Norway" :capital "Oslo" :population 5500000}
+                                  {:code "IS" :name "Iceland" :capital "Reykjavík" :population 390000 :tags #{:island}}]
+                      :updated #inst "2024-01-01T00:00:00Z"})"));
+}
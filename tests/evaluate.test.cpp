@@ -1,9 +1,80 @@
 #include <gmock/gmock.h>
 
 #include <edn/evaluate.hpp>
+#include <thread>
 
 TEST(evaluate, value_evaluates_to_itself)
 {
     edn::stack_t stack{ nullptr };
     EXPECT_THAT(edn::evaluate(3, stack), 3);
 }
+
+TEST(evaluate, atom_reset_and_deref)
+{
+    edn::stack_t stack{ nullptr };
+    EXPECT_THAT(edn::evaluate(edn::parse("(let [a (atom 1)] (reset! a 5) (deref a))"), stack), 5);
+}
+
+TEST(evaluate, atom_swap_applies_function_with_extra_arguments)
+{
+    edn::stack_t stack{ nullptr };
+    stack.insert(
+        edn::symbol_t{ "add" },
+        edn::callable_t{ [](const std::vector<edn::value_t>& args) -> edn::value_t
+                         { return *args.at(0).if_integer() + *args.at(1).if_integer(); } });
+    EXPECT_THAT(edn::evaluate(edn::parse("(let [a (atom 1)] (swap! a add 10) (swap! a add 100))"), stack), 111);
+}
+
+TEST(evaluate, atom_swap_is_atomic_across_threads)
+{
+    const edn::atom_t counter{ 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    counter.swap([](const edn::value_t& v) -> edn::value_t { return *v.if_integer() + 1; });
+                }
+            });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_THAT(counter.deref(), 4000);
+}
+
+TEST(evaluate, future_is_computed_on_thread_pool)
+{
+    edn::stack_t stack{ nullptr };
+    EXPECT_THAT(edn::evaluate(edn::parse("(let [f (future [1 2] [3 4])] (deref f))"), stack), (edn::vector_t{ 3, 4 }));
+}
+
+TEST(evaluate, promise_is_delivered_once)
+{
+    edn::stack_t stack{ nullptr };
+    EXPECT_THAT(edn::evaluate(edn::parse("(let [p (promise)] (deliver p 1) (deliver p 2) (deref p))"), stack), 1);
+}
+
+TEST(evaluate, nested_futures_do_not_starve_the_pool)
+{
+    edn::thread_pool pool{ 1 };
+    const edn::future_t outer = pool.async(
+        [&]() -> edn::value_t
+        {
+            const edn::future_t inner = pool.async([]() -> edn::value_t { return 42; });
+            return pool.deref(inner);
+        });
+    EXPECT_THAT(pool.deref(outer), 42);
+}
+
+TEST(evaluate, sorted_map_range_queries)
+{
+    edn::stack_t stack{ nullptr };
+    edn::evaluate(edn::parse("(def events (sorted-map 30 :c 10 :a 20 :b 40 :d))"), stack);
+    EXPECT_THAT(edn::evaluate(edn::parse("(subseq events >= 20 < 40)"), stack), edn::parse("([20 :b] [30 :c])"));
+    EXPECT_THAT(edn::evaluate(edn::parse("(rsubseq (sorted-set 3 1 2) > 1)"), stack), edn::parse("(3 2)"));
+}
@@ -0,0 +1,99 @@
+#include <gmock/gmock.h>
+
+#include <edn/frozen.hpp>
+#include <edn/memory.hpp>
+#include <vector>
+
+#include "matchers.hpp"
+
+TEST(frozen, round_trips_through_thaw)
+{
+    const edn::value_t value = edn::parse(
+        R"({:name "frozen" :ids [1 2 3] :ratio 0.5 :flags #{true false} :body (f 'x \a nil) :at #inst "2020"})");
+    const edn::frozen_t frozen = edn::freeze(value);
+    EXPECT_EQ(frozen.root().thaw(), value);
+    EXPECT_TRUE(frozen.root() == value);
+    EXPECT_EQ(edn::str(frozen.root()), edn::str(value));
+    EXPECT_THROW(edn::freeze(edn::atom_t{ 1 }), std::runtime_error);
+}
+
+TEST(frozen, reads_through_accessors)
+{
+    const edn::frozen_t frozen = edn::freeze(edn::parse(R"({:name "frozen" :ids [1 2 3] :tag #point [1.5 2.5]})"));
+    const edn::frozen_map_t root = *frozen.root().if_map();
+    EXPECT_EQ(root.size(), 3);
+    EXPECT_FALSE(frozen.root().if_vector());
+    EXPECT_EQ(root.at(edn::keyword_t{ "name" }).if_string(), "frozen");
+    EXPECT_FALSE(root.find(edn::keyword_t{ "missing" }));
+    EXPECT_THROW(root.at(edn::keyword_t{ "missing" }), std::out_of_range);
+
+    const edn::frozen_sequence_t ids = *root.at(edn::keyword_t{ "ids" }).if_vector();
+    std::vector<int> items;
+    for (const edn::frozen_value_t item : ids)
+    {
+        items.push_back(*item.if_integer());
+    }
+    EXPECT_THAT(items, testing::ElementsAre(1, 2, 3));
+    EXPECT_TRUE(ids.contains(2));
+    EXPECT_THROW(ids.at(3), std::out_of_range);
+
+    std::vector<std::string_view> keys;
+    for (const auto& [key, item] : root)
+    {
+        keys.push_back(*key.if_keyword());
+    }
+    EXPECT_THAT(keys, testing::ElementsAre("name", "ids", "tag"));
+
+    const edn::frozen_tagged_element_t tagged = *root.at(edn::keyword_t{ "tag" }).if_tagged_element();
+    EXPECT_EQ(tagged.tag(), "point");
+    EXPECT_EQ(*tagged.element().if_vector()->at(1).if_floating_point(), 2.5);
+}
+
+TEST(frozen, searches_sorted_collections)
+{
+    edn::sorted_map_t map = {};
+    edn::sorted_set_t set = {};
+    for (int i = 0; i < 100; ++i)
+    {
+        map.insert_or_assign(i * 2, edn::str(i));
+        set.insert(i * 3);
+    }
+    const edn::frozen_t frozen_map = edn::freeze(map);
+    const edn::frozen_map_t entries = *frozen_map.root().if_sorted_map();
+    EXPECT_EQ(entries.at(84).if_string(), "42");
+    EXPECT_FALSE(entries.contains(85));
+
+    const edn::frozen_t frozen_set = edn::freeze(set);
+    const edn::frozen_sequence_t items = *frozen_set.root().if_sorted_set();
+    EXPECT_TRUE(items.contains(297));
+    EXPECT_FALSE(items.contains(298));
+    EXPECT_EQ(frozen_set.root().thaw(), edn::value_t{ set });
+}
+
+TEST(frozen, shares_strings_and_drops_slack)
+{
+    edn::vector_t items = {};
+    items.reserve(1000);
+    for (int i = 0; i < 100; ++i)
+    {
+        items.push_back(edn::parse("{:name \"a string that does not fit inline\" :id 1}"));
+    }
+    const edn::value_t value = items;
+    const edn::frozen_t frozen = edn::freeze(value);
+    // 1 + 100 * 5 nodes of 16 bytes, one copy of each string.
+    EXPECT_LT(frozen.size(), 501 * 16 + 100);
+    EXPECT_LT(frozen.size() * 4, edn::memory_usage(value).total().total());
+}
+
+TEST(frozen, views_relocated_blocks)
+{
+    const edn::value_t value = edn::parse("[{:a 1} \"text\" #{:x}]");
+    const edn::frozen_t frozen = edn::freeze(value);
+    std::vector<std::uint64_t> copy(frozen.size() / sizeof(std::uint64_t));
+    std::memcpy(copy.data(), frozen.data(), frozen.size());
+    EXPECT_EQ(edn::frozen_root(copy.data(), frozen.size()).thaw(), value);
+
+    EXPECT_THROW(edn::frozen_root(copy.data(), 16), std::runtime_error);
+    copy[3] = 0x000000ff00000008ULL;  // the root, as a vector claiming 255 elements
+    EXPECT_THROW(edn::frozen_root(copy.data(), frozen.size()), std::runtime_error);
+}
@@ -0,0 +1,48 @@
+#include <gmock/gmock.h>
+
+#include <edn/evaluate.hpp>
+#include <edn/gc.hpp>
+
+TEST(gc, reclaims_self_referencing_atom)
+{
+    edn::gc_heap heap{ 0 };
+    std::weak_ptr<edn::atom_t::state_t> weak;
+    {
+        const edn::atom_t atom = heap.track(edn::atom_t{ 0 });
+        atom.reset(edn::vector_t{ atom });
+        weak = atom.m_state;
+    }
+    EXPECT_FALSE(weak.expired());
+    EXPECT_THAT(heap.collect(), 1);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_THAT(heap.statistics().collections, 1);
+}
+
+TEST(gc, keeps_cells_reachable_from_roots_and_host)
+{
+    edn::gc_heap heap{ 0 };
+    edn::stack_t stack{ nullptr };
+    stack.m_heap = &heap;
+
+    edn::evaluate(edn::parse("(def a (atom (atom 1)))"), stack);
+    const edn::atom_t held = heap.track(edn::atom_t{ 2 });
+
+    EXPECT_THAT(heap.collect(stack), 0);
+    EXPECT_THAT(edn::evaluate(edn::parse("(deref (deref a))"), stack), 1);
+    EXPECT_THAT(held.deref(), 2);
+    EXPECT_THAT(heap.statistics().live_cells, 3);
+}
+
+TEST(gc, collects_when_allocation_interval_is_reached)
+{
+    edn::gc_heap heap{ 2 };
+    edn::stack_t stack{ nullptr };
+    stack.m_heap = &heap;
+
+    edn::evaluate(edn::parse("(let [a (atom 0)] (reset! a [a]))"), stack);
+    edn::evaluate(edn::parse("(atom 1)"), stack);
+    EXPECT_THAT(heap.statistics().collections, 0);
+    edn::evaluate(edn::parse("(atom 2)"), stack);
+    EXPECT_THAT(heap.statistics().collections, 1);
+    EXPECT_THAT(heap.statistics().reclaimed_cells, 1);
+}
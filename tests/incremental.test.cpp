@@ -0,0 +1,71 @@
+#include <gmock/gmock.h>
+
+#include <edn/incremental.hpp>
+#include <string>
+
+#include "matchers.hpp"
+
+namespace
+{
+
+// Applies the edit to `text` and `source`, and checks the result against parsing the whole text again.
+edn::span_t edit(
+    std::string& text, edn::parsed_source_t& source, std::size_t offset, std::size_t removed, const std::string& inserted)
+{
+    text.replace(offset, removed, inserted);
+    const edn::span_t reparsed = edn::reparse(source, text, edn::text_edit_t{ offset, removed, inserted.size() });
+    const edn::parsed_source_t expected = edn::parse_with_spans(text);
+    EXPECT_THAT(source.m_forms, testing::ElementsAreArray(expected.m_forms)) << text;
+    EXPECT_TRUE(source.m_spans == expected.m_spans) << text;
+    return reparsed;
+}
+
+}  // namespace
+
+TEST(incremental, records_spans)
+{
+    const edn::parsed_source_t source = edn::parse_with_spans("a [1 {:k 22}]\n; note\n#{x}");
+    ASSERT_THAT(source.m_spans, testing::SizeIs(3));
+    EXPECT_EQ(source.m_spans[1].m_begin, 2);
+    EXPECT_EQ(source.m_spans[1].m_end, 13);
+    EXPECT_EQ(source.m_spans[1].m_children[1].m_children[1].m_begin, 4);
+    EXPECT_EQ(source.m_spans[1].m_children[1].m_children[1].size(), 2);
+    EXPECT_THAT(source.m_forms[2], WhenSerialized(testing::StrEq("#{x}")));
+}
+
+TEST(incremental, reparses_innermost_enclosing_collection)
+{
+    std::string text = "(def a 1)\n{:db {:port 80 :hosts [\"a\" \"b\"]}}\n(def b 2)";
+    edn::parsed_source_t source = edn::parse_with_spans(text);
+    const std::size_t port = text.find("80");
+    const edn::span_t reparsed = edit(text, source, port, 2, "8080");
+    EXPECT_EQ(text.substr(reparsed.m_begin, reparsed.size()), "{:port 8080 :hosts [\"a\" \"b\"]}");
+
+    const std::size_t host = text.find("\"b\"") + 1;
+    EXPECT_EQ(edit(text, source, host, 1, "bb").size(), 4);
+}
+
+TEST(incremental, reparses_touched_top_level_forms)
+{
+    std::string text = "a b\nc";
+    edn::parsed_source_t source = edn::parse_with_spans(text);
+    edit(text, source, 1, 0, "x");
+    edit(text, source, 2, 1, "");
+    edit(text, source, 2, 0, " [1 2]");
+    edit(text, source, 0, 0, "; ");
+    edit(text, source, 0, 2, "");
+    edit(text, source, text.size(), 0, "\n{:k v}");
+    EXPECT_EQ(text, "ax [1 2]b\nc\n{:k v}");
+}
+
+TEST(incremental, unbalanced_edit_throws_and_keeps_source)
+{
+    std::string text = "[1 2] [3]";
+    edn::parsed_source_t source = edn::parse_with_spans(text);
+    const std::string broken = "[1 2 [3]";
+    EXPECT_THROW(edn::reparse(source, broken, edn::text_edit_t{ 4, 1, 0 }), edn::parse_error);
+    EXPECT_THAT(source.m_forms, testing::ElementsAre(edn::parse("[1 2]"), edn::parse("[3]")));
+
+    edit(text, source, text.find("2]"), 6, "2 [3]]");
+    EXPECT_THAT(source.m_forms, testing::ElementsAre(edn::parse("[1 2 [3]]")));
+}
@@ -0,0 +1,97 @@
+#include <gmock/gmock.h>
+
+#include <edn/ingest.hpp>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace
+{
+
+class ingest_files_t
+{
+public:
+    ingest_files_t() : m_directory(std::filesystem::temp_directory_path() / "edn-ingest")
+    {
+        std::filesystem::remove_all(m_directory);
+        std::filesystem::create_directories(m_directory);
+        for (int i = 0; i < 100; ++i)
+        {
+            add(edn::str("file-", i, ".edn"), edn::str("{:id ", i, " :items [", i, " ", i + 1, "]}"));
+        }
+        std::string large = "[";
+        for (int i = 0; i < 200000; ++i)
+        {
+            large += edn::str(i, " ");
+        }
+        add("large.edn", large + "]");
+        add("empty.edn", "");
+        add("broken.edn", "{:id");
+        m_paths.push_back(m_directory / "missing.edn");
+    }
+
+    ~ingest_files_t() { std::filesystem::remove_all(m_directory); }
+
+    const std::vector<std::filesystem::path>& paths() const { return m_paths; }
+
+private:
+    std::filesystem::path m_directory;
+    std::vector<std::filesystem::path> m_paths;
+
+    void add(const std::string& name, const std::string& text)
+    {
+        m_paths.push_back(m_directory / name);
+        std::ofstream{ m_paths.back() } << text;
+    }
+};
+
+void expect_ingested(bool use_io_uring)
+{
+    const ingest_files_t files;
+    std::mutex mutex;
+    std::map<std::string, edn::value_t> values;
+    std::vector<std::string> errors;
+
+    edn::ingest_options_t options = {};
+    options.max_in_flight = 8;
+    options.use_io_uring = use_io_uring;
+    options.on_error = [&](const std::filesystem::path& path, const std::exception&)
+    {
+        std::lock_guard<std::mutex> lock{ mutex };
+        errors.push_back(path.filename().string());
+    };
+    const edn::ingest_statistics_t statistics = edn::ingest(
+        files.paths(),
+        [&](const std::filesystem::path& path, edn::value_t value)
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            values.emplace(path.filename().string(), std::move(value));
+        },
+        options);
+
+    EXPECT_EQ(statistics.files, 102);
+    EXPECT_EQ(statistics.failed, 2);
+    EXPECT_THAT(errors, testing::UnorderedElementsAre("broken.edn", "missing.edn"));
+    ASSERT_EQ(values.size(), 102);
+    EXPECT_EQ(values["file-42.edn"], edn::parse("{:id 42 :items [42 43]}"));
+    EXPECT_EQ(values["large.edn"].if_vector()->size(), 200000);
+    EXPECT_EQ(*values["large.edn"].if_vector()->back().if_integer(), 199999);
+    EXPECT_TRUE(values["empty.edn"].is_nil());
+    if (!use_io_uring)
+    {
+        EXPECT_FALSE(statistics.io_uring);
+    }
+}
+
+}  // namespace
+
+TEST(ingest, reads_and_parses_files)
+{
+    expect_ingested(true);
+}
+
+TEST(ingest, reads_with_blocking_fallback)
+{
+    expect_ingested(false);
+}
@@ -0,0 +1,99 @@
+#include <gmock/gmock.h>
+
+#include <edn/json.hpp>
+#include <cmath>
+#include <sstream>
+
+TEST(json, writes_scalars)
+{
+    EXPECT_EQ(edn::to_json(edn::parse("nil")), "null");
+    EXPECT_EQ(edn::to_json(edn::parse("true")), "true");
+    EXPECT_EQ(edn::to_json(edn::parse("-42")), "-42");
+    EXPECT_EQ(edn::to_json(edn::parse("2.5")), "2.5");
+    EXPECT_EQ(edn::to_json(edn::parse("3.0")), "3.0");
+    EXPECT_EQ(edn::to_json(edn::parse("0.1")), "0.1");
+    EXPECT_EQ(edn::to_json(edn::parse(":name")), "\"name\"");
+    EXPECT_EQ(edn::to_json(edn::parse("\\a")), "\"a\"");
+    EXPECT_EQ(edn::to_json(edn::value_t{ std::string{ "a\"b\\c\nd\x01" } }), "\"a\\\"b\\\\c\\nd\\u0001\"");
+}
+
+TEST(json, writes_collections)
+{
+    EXPECT_EQ(
+        edn::to_json(edn::parse("{:id 1 \"tags\" #{:a} [1 2] (x y) :when #inst \"2020\"}")),
+        "{\"id\":1,\"tags\":[\"a\"],\"[1 2]\":[\"x\",\"y\"],\"when\":\"2020\"}");
+    EXPECT_EQ(edn::to_json(edn::parse("[]")), "[]");
+    EXPECT_EQ(edn::to_json(edn::parse("{}")), "{}");
+}
+
+TEST(json, rejects_values_without_json_form)
+{
+    EXPECT_THROW(edn::to_json(edn::value_t{ std::nan("") }), std::runtime_error);
+    const edn::callable_t callable{ [](const std::vector<edn::value_t>&) { return edn::value_t{}; } };
+    EXPECT_THROW(edn::to_json(callable), std::runtime_error);
+}
+
+TEST(json, reads_documents)
+{
+    EXPECT_EQ(
+        edn::parse_json(R"( {"id": 1, "tags": ["a", true, null], "score": -2.5e1, "big": 10000000000, "id": 2} )"),
+        edn::parse("{:id 2 :tags [\"a\" true nil] :score -25.0 :big 10000000000.0}"));
+    edn::json_read_options_t options = {};
+    options.keys = edn::json_keys_t::string;
+    EXPECT_EQ(edn::parse_json(R"({"a b": {}})", options), edn::parse("{\"a b\" {}}"));
+    EXPECT_EQ(
+        edn::parse_json(R"("q\"\\\/\n\u00e9\ud83d\ude00")"),
+        edn::value_t{ std::string{ "q\"\\/\n\xc3\xa9\xf0\x9f\x98\x80" } });
+}
+
+TEST(json, round_trips_through_writer)
+{
+    const edn::value_t value = edn::parse("{:a [1 -2 0.5 1e300 \"x\\ty\"] :b {:c nil :d false}}");
+    EXPECT_EQ(edn::parse_json(edn::to_json(value)), value);
+}
+
+TEST(json, reports_errors_with_location)
+{
+    EXPECT_THROW(edn::parse_json("[1, 2"), edn::parse_error);
+    EXPECT_THROW(edn::parse_json("[1 2]"), edn::parse_error);
+    EXPECT_THROW(edn::parse_json("{\"a\" 1}"), edn::parse_error);
+    EXPECT_THROW(edn::parse_json("tru"), edn::parse_error);
+    EXPECT_THROW(edn::parse_json("1 2"), edn::parse_error);
+    EXPECT_THROW(edn::parse_json("\"\\x\""), edn::parse_error);
+    EXPECT_THROW(edn::parse_json(std::string(1000, '[')), edn::parse_error);
+    try
+    {
+        edn::parse_json("{\n  \"a\": ?\n}");
+        FAIL();
+    }
+    catch (const edn::parse_error& error)
+    {
+        EXPECT_EQ(error.location.line, 1);
+        EXPECT_EQ(error.location.column, 7);
+    }
+}
+
+TEST(json, reader_streams_documents_across_chunks)
+{
+    std::string input;
+    for (int i = 0; i < 1000; ++i)
+    {
+        input += edn::str("{\"id\": ", i, ", \"name\": \"item ", i, "\"}\n");
+    }
+    input += "12";
+    std::istringstream is{ input };
+    edn::json_reader reader{ is, {}, 7 };
+    for (int i = 0; i < 1000; ++i)
+    {
+        const std::optional<edn::value_t> value = reader.next();
+        ASSERT_TRUE(value);
+        ASSERT_EQ(*value, edn::parse(edn::str("{:id ", i, " :name \"item ", i, "\"}")));
+    }
+    EXPECT_EQ(reader.next(), edn::value_t{ 12 });
+    EXPECT_EQ(reader.next(), std::nullopt);
+
+    std::istringstream broken{ "[1] [2" };
+    edn::json_reader broken_reader{ broken };
+    EXPECT_EQ(broken_reader.next(), edn::parse("[1]"));
+    EXPECT_THROW(broken_reader.next(), edn::parse_error);
+}
@@ -0,0 +1,45 @@
+#include <gmock/gmock.h>
+
+#include <edn/memory.hpp>
+
+#include "matchers.hpp"
+
+TEST(memory, counts_values_by_type)
+{
+    const edn::memory_usage_t usage
+        = edn::memory_usage(edn::parse("{:name \"a string that does not fit inline\" :ids [1 2 3]}"));
+    EXPECT_EQ(usage[edn::value_type_t::map].count, 1);
+    EXPECT_EQ(usage[edn::value_type_t::keyword].count, 2);
+    EXPECT_EQ(usage[edn::value_type_t::integer].count, 3);
+    EXPECT_EQ(usage[edn::value_type_t::integer].node_bytes, 3 * sizeof(edn::value_t));
+    EXPECT_GT(usage[edn::value_type_t::string].string_bytes, 30);
+    EXPECT_EQ(usage[edn::value_type_t::keyword].string_bytes, 0);
+    EXPECT_GE(usage[edn::value_type_t::vector].box_bytes, sizeof(edn::vector_t));
+    EXPECT_EQ(usage.total().count, 8);
+}
+
+TEST(memory, reports_slack)
+{
+    edn::value_t value = edn::vector_t{};
+    edn::vector_t& items = *value.if_mutable<edn::vector_t>();
+    items.reserve(10);
+    items.push_back(1);
+    const edn::memory_usage_t usage = edn::memory_usage(value);
+    EXPECT_EQ(usage[edn::value_type_t::vector].slack_bytes, (items.capacity() - 1) * sizeof(edn::value_t));
+
+    items.shrink_to_fit();
+    EXPECT_EQ(edn::memory_usage(value)[edn::value_type_t::vector].slack_bytes, 0);
+}
+
+TEST(memory, accounts_for_tree_nodes)
+{
+    edn::sorted_set_t set = {};
+    for (int i = 0; i < 100; ++i)
+    {
+        set.insert(i);
+    }
+    const edn::memory_usage_t usage = edn::memory_usage(set);
+    EXPECT_EQ(usage[edn::value_type_t::integer].count, 100);
+    EXPECT_GT(usage[edn::value_type_t::sorted_set].box_bytes, sizeof(edn::sorted_set_t));
+    EXPECT_THAT(usage, WhenSerialized(testing::HasSubstr("sorted_set: count=1")));
+}
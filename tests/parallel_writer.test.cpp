@@ -0,0 +1,96 @@
+#include <gmock/gmock.h>
+
+#include <edn/parallel_writer.hpp>
+#include <cstdio>
+#include <sstream>
+
+namespace
+{
+
+edn::value_t large_vector()
+{
+    edn::vector_t items;
+    for (int i = 0; i < 5000; ++i)
+    {
+        items.push_back(edn::parse(edn::str("{:id ", i, " :name \"item ", i, "\" :tags #{:a} :score ", i * 0.25, "}")));
+    }
+    return items;
+}
+
+std::string sequential(const edn::value_t& value, edn::writer_options_t options = {})
+{
+    std::string result;
+    edn::stream_writer{ result, options }.value(value);
+    return result;
+}
+
+std::string parallel(const edn::value_t& value, edn::parallel_writer_options_t options)
+{
+    std::ostringstream os;
+    edn::write_parallel(os, value, options);
+    return os.str();
+}
+
+}  // namespace
+
+TEST(parallel_writer, matches_sequential_output)
+{
+    const edn::value_t value = large_vector();
+    edn::thread_pool pool{ 4 };
+    edn::parallel_writer_options_t options = {};
+    options.pool = &pool;
+    options.chunk_size = 100;
+    options.max_in_flight = 3;
+    EXPECT_EQ(parallel(value, options), sequential(value));
+
+    options.format.pretty = true;
+    EXPECT_EQ(parallel(value, options), sequential(value, options.format));
+}
+
+TEST(parallel_writer, writes_maps_and_small_values)
+{
+    edn::map_builder builder{ 5000 };
+    for (int i = 0; i < 5000; ++i)
+    {
+        builder.insert(edn::keyword_t{ edn::str("k", i).c_str() }, edn::vector_t{ i, edn::str(i) });
+    }
+    const edn::value_t map = std::move(builder).build();
+    edn::parallel_writer_options_t options = {};
+    options.chunk_size = 64;
+    EXPECT_EQ(parallel(map, options), sequential(map));
+    EXPECT_EQ(edn::parse(parallel(map, options)), map);
+    EXPECT_EQ(parallel(edn::parse("[1 2 3]"), options), "[1 2 3]\n");
+    EXPECT_EQ(parallel(edn::value_t{ 42 }, options), "42\n");
+}
+
+TEST(parallel_writer, reports_values_that_cannot_be_written)
+{
+    edn::vector_t items(1000, edn::value_t{ 1 });
+    items[700] = edn::callable_t{ [](const std::vector<edn::value_t>&) { return edn::value_t{}; } };
+    edn::parallel_writer_options_t options = {};
+    options.chunk_size = 10;
+    EXPECT_THROW(parallel(items, options), std::runtime_error);
+}
+
+#if EDN_HAS_WRITEV
+
+TEST(parallel_writer, writes_to_file_descriptor)
+{
+    const edn::value_t value = large_vector();
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    edn::parallel_writer_options_t options = {};
+    options.chunk_size = 50;
+    edn::write_parallel(::fileno(file), value, options);
+    std::rewind(file);
+    std::string text;
+    char buffer[4096];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;)
+    {
+        text.append(buffer, n);
+    }
+    std::fclose(file);
+    EXPECT_EQ(text, sequential(value));
+}
+
+#endif
@@ -35,3 +35,18 @@ TEST(parse, tagged_element_without_space)
         IsTaggedElement(
             testing::AllOf(TagIs(testing::StrEq("inst")), TaggedElementIs(IsString(testing::StrEq("2024-01-01"))))));
 }
+
+TEST(parse, map_with_repeated_key)
+{
+    EXPECT_THAT(edn::parse("{:a 1 :b 2 :a 3}"), WhenSerialized(testing::StrEq("{:a 3 :b 2}")));
+}
+
+TEST(parse, set_with_mixed_types)
+{
+    EXPECT_THAT(edn::parse(R"(#{1 "1" :1 1})"), IsSet(testing::SizeIs(3)));
+}
+
+TEST(parse, set_keeps_first_element)
+{
+    EXPECT_THAT(edn::parse("#{12 3}"), WhenSerialized(testing::StrEq("#{3 12}")));
+}
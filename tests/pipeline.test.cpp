@@ -0,0 +1,134 @@
+#include <gmock/gmock.h>
+
+#include <edn/pipeline.hpp>
+#include <sstream>
+
+namespace
+{
+
+std::vector<std::string> split_forms(std::string_view text, std::size_t chunk_size)
+{
+    edn::detail::form_splitter_t splitter;
+    std::vector<std::string> result;
+    const auto emit = [&](std::string form) { result.push_back(std::move(form)); };
+    for (std::size_t i = 0; i < text.size(); i += chunk_size)
+    {
+        splitter.feed(text.substr(i, chunk_size), emit);
+    }
+    splitter.finish(emit);
+    return result;
+}
+
+}  // namespace
+
+TEST(pipeline, splitter_cuts_top_level_forms)
+{
+    const std::string_view text
+        = "{:a [1 2]} \"x ] \\\" y\" ; comment ]\n #inst \"2020\" 'sym #_ignored (a \\) b) ##Inf #{1} \\space 42";
+    const std::vector<std::string> expected = {
+        "{:a [1 2]}", "\"x ] \\\" y\"", "#inst \"2020\"", "'sym", "#_ignored", "(a \\) b)", "##Inf", "#{1}", "\\space", "42"
+    };
+    EXPECT_THAT(split_forms(text, text.size()), testing::ElementsAreArray(expected));
+    EXPECT_THAT(split_forms(text, 1), testing::ElementsAreArray(expected));
+    EXPECT_THAT(split_forms(text, 7), testing::ElementsAreArray(expected));
+}
+
+TEST(pipeline, spsc_queue_preserves_order)
+{
+    edn::detail::spsc_queue_t<std::optional<int>> queue{ 4 };
+    std::thread producer{ [&]()
+                          {
+                              for (int i = 0; i < 10000; ++i)
+                              {
+                                  queue.push(i);
+                              }
+                              queue.push(std::nullopt);
+                          } };
+    int expected = 0;
+    while (const std::optional<int> item = queue.pop())
+    {
+        ASSERT_EQ(*item, expected++);
+    }
+    producer.join();
+    EXPECT_EQ(expected, 10000);
+}
+
+TEST(pipeline, transforms_records_in_order)
+{
+    std::string input;
+    for (int i = 0; i < 5000; ++i)
+    {
+        input += edn::str("{:id ", i, "}\n");
+    }
+    std::istringstream is{ input };
+    std::ostringstream os;
+
+    edn::pipeline_options_t options = {};
+    options.queue_capacity = 16;
+    options.read_size = 100;
+    const edn::pipeline_statistics statistics
+        = edn::pipeline_t{ options }
+              .transform(
+                  "id",
+                  [](edn::value_t record) -> std::optional<edn::value_t>
+                  { return record.if_map()->at(edn::keyword_t{ "id" }); })
+              .filter("even", [](const edn::value_t& id) { return *id.if_integer() % 2 == 0; })
+              .run(is, os);
+
+    std::string expected;
+    for (int i = 0; i < 5000; i += 2)
+    {
+        expected += edn::str(i, "\n");
+    }
+    EXPECT_EQ(os.str(), expected);
+    ASSERT_EQ(statistics.stages.size(), 5);
+    EXPECT_EQ(statistics.stages[1].name, "parse");
+    EXPECT_EQ(statistics.stages[1].records_out, 5000);
+    EXPECT_EQ(statistics.stages[3].name, "even");
+    EXPECT_EQ(statistics.stages[3].records_in, 5000);
+    EXPECT_EQ(statistics.stages[3].records_out, 2500);
+    EXPECT_EQ(statistics.stages[4].records_out, 2500);
+}
+
+TEST(pipeline, transforms_with_evaluator_program)
+{
+    std::istringstream is{ "1 nil 2 [3]" };
+    std::ostringstream os;
+    const edn::stack_t::frame_type bindings = {
+        { edn::symbol_t{ "wrap" },
+          edn::callable_t{ [](const std::vector<edn::value_t>& args) -> edn::value_t
+                           { return edn::vector_t{ args.at(0) }; } } },
+        { edn::symbol_t{ "some?" },
+          edn::callable_t{ [](const std::vector<edn::value_t>& args) -> edn::value_t { return !args.at(0).is_nil(); } } },
+    };
+    edn::pipeline_t{}.transform("wrap", edn::parse("(fn [r] (if (some? r) (wrap r) nil))"), bindings).run(is, os);
+    EXPECT_EQ(os.str(), "[1]\n[2]\n[[3]]\n");
+    EXPECT_THROW(edn::pipeline_t{}.transform("bad", edn::parse("42")), std::runtime_error);
+}
+
+TEST(pipeline, reports_errors)
+{
+    std::vector<std::string> errors;
+    edn::pipeline_options_t options = {};
+    options.on_error = [&](const std::string& stage, const std::exception&) { errors.push_back(stage); };
+    const auto fail_on_two = [](edn::value_t record) -> std::optional<edn::value_t>
+    {
+        if (record == edn::value_t{ 2 })
+        {
+            throw std::runtime_error{ "two" };
+        }
+        return record;
+    };
+
+    std::istringstream is{ "1 2 (3 4 \"unterminated" };
+    std::ostringstream os;
+    const edn::pipeline_statistics statistics = edn::pipeline_t{ options }.transform("check", fail_on_two).run(is, os);
+    EXPECT_EQ(os.str(), "1\n");
+    EXPECT_THAT(errors, testing::UnorderedElementsAre("parse", "check"));
+    EXPECT_EQ(statistics.stages[1].errors, 1);
+    EXPECT_EQ(statistics.stages[2].errors, 1);
+
+    std::istringstream again{ "1 2 3" };
+    std::ostringstream out;
+    EXPECT_THROW(edn::pipeline_t{}.transform("check", fail_on_two).run(again, out), std::runtime_error);
+}
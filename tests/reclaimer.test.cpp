@@ -0,0 +1,94 @@
+#include <gmock/gmock.h>
+
+#include <edn/reclaimer.hpp>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace
+{
+
+// Records the thread destroying the tree that holds it; optionally signals `started` and waits for `release` first.
+struct probe_t
+{
+    std::promise<std::thread::id>* m_destroyed_on;
+    std::promise<void>* m_started = nullptr;
+    std::shared_future<void> m_release = {};
+
+    ~probe_t()
+    {
+        if (m_started)
+        {
+            m_started->set_value();
+            m_release.wait();
+        }
+        m_destroyed_on->set_value(std::this_thread::get_id());
+    }
+};
+
+edn::value_t tree_with(probe_t* probe)
+{
+    const std::shared_ptr<probe_t> state{ probe };
+    return edn::vector_t{ edn::callable_t{ [state](const std::vector<edn::value_t>&) { return edn::value_t{}; } } };
+}
+
+}  // namespace
+
+TEST(reclaimer, destroys_retired_trees_in_background)
+{
+    edn::deferred_reclaimer reclaimer{};
+    std::promise<std::thread::id> destroyed_on;
+    edn::value_t value = tree_with(new probe_t{ &destroyed_on });
+    reclaimer.retire(value);
+    EXPECT_TRUE(value.is_nil());
+    EXPECT_NE(destroyed_on.get_future().get(), std::this_thread::get_id());
+
+    reclaimer.retire(edn::value_t{ 42 });
+    reclaimer.drain();
+    const edn::reclaimer_statistics statistics = reclaimer.statistics();
+    EXPECT_EQ(statistics.retired, 1);
+    EXPECT_EQ(statistics.reclaimed, 1);
+    EXPECT_EQ(statistics.queue_depth, 0);
+}
+
+TEST(reclaimer, destroys_inline_when_full)
+{
+    edn::deferred_reclaimer reclaimer{ 1 };
+    std::promise<void> started;
+    std::promise<void> release;
+    std::promise<std::thread::id> first;
+    std::promise<std::thread::id> second;
+    std::promise<std::thread::id> third;
+
+    reclaimer.retire(tree_with(new probe_t{ &first, &started, release.get_future().share() }));
+    started.get_future().wait();  // the reclaimer is busy and its queue is empty
+    reclaimer.retire(tree_with(new probe_t{ &second }));
+    reclaimer.retire(tree_with(new probe_t{ &third }));
+    EXPECT_EQ(third.get_future().get(), std::this_thread::get_id());
+
+    release.set_value();
+    reclaimer.drain();
+    EXPECT_NE(second.get_future().get(), std::this_thread::get_id());
+    const edn::reclaimer_statistics statistics = reclaimer.statistics();
+    EXPECT_EQ(statistics.retired, 2);
+    EXPECT_EQ(statistics.destroyed_inline, 1);
+    EXPECT_EQ(statistics.reclaimed, 2);
+    EXPECT_EQ(statistics.max_queue_depth, 1);
+}
+
+TEST(reclaimer, blocks_when_full)
+{
+    edn::deferred_reclaimer reclaimer{ 1, edn::reclaimer_overflow_t::block };
+    std::promise<std::thread::id> destroyed[8];
+    for (std::promise<std::thread::id>& promise : destroyed)
+    {
+        reclaimer.retire(tree_with(new probe_t{ &promise }));
+    }
+    reclaimer.drain();
+    for (std::promise<std::thread::id>& promise : destroyed)
+    {
+        EXPECT_NE(promise.get_future().get(), std::this_thread::get_id());
+    }
+    EXPECT_EQ(reclaimer.statistics().reclaimed, 8);
+    EXPECT_EQ(reclaimer.statistics().destroyed_inline, 0);
+}
@@ -0,0 +1,170 @@
+#include <gmock/gmock.h>
+
+#include <edn/record_log.hpp>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace
+{
+
+class log_directory_t
+{
+public:
+    log_directory_t() : m_directory(std::filesystem::temp_directory_path() / "edn-record-log")
+    {
+        std::filesystem::remove_all(m_directory);
+        std::filesystem::create_directories(m_directory);
+    }
+
+    ~log_directory_t() { std::filesystem::remove_all(m_directory); }
+
+    std::filesystem::path path() const { return m_directory / "log.edn"; }
+
+private:
+    std::filesystem::path m_directory;
+};
+
+edn::value_t record(int i)
+{
+    return edn::parse(edn::str("{:seq ", i, " :text \"line ", i, "\nnext\" :tags [:a :b]}"));
+}
+
+edn::record_log_options_t keyed(std::size_t interval)
+{
+    edn::record_log_options_t options = {};
+    options.key = edn::keyword_t{ "seq" };
+    options.key_interval = interval;
+    return options;
+}
+
+void append_raw(const std::filesystem::path& path, const std::string& bytes)
+{
+    std::ofstream{ path, std::ios::binary | std::ios::app } << bytes;
+}
+
+}  // namespace
+
+TEST(record_log, appends_and_reads_records)
+{
+    const log_directory_t directory;
+    {
+        edn::record_log log{ directory.path() };
+        for (int i = 0; i < 100; ++i)
+        {
+            EXPECT_EQ(log.append(record(i)), static_cast<std::size_t>(i));
+        }
+        EXPECT_EQ(log.read(42), record(42));
+    }
+    edn::record_log log{ directory.path() };
+    EXPECT_EQ(log.size(), 100);
+    EXPECT_EQ(log.recovered_records(), 0);
+    EXPECT_EQ(log.read(0), record(0));
+    EXPECT_EQ(log.read(99), record(99));
+    EXPECT_THROW(log.read(100), std::out_of_range);
+    EXPECT_EQ(log.append(record(100)), 100);
+    EXPECT_EQ(log.read(100), record(100));
+}
+
+TEST(record_log, scans_ranges_in_parallel)
+{
+    const log_directory_t directory;
+    edn::record_log log{ directory.path() };
+    for (int i = 0; i < 1000; ++i)
+    {
+        log.append(record(i));
+    }
+    edn::thread_pool pool{ 4 };
+    std::mutex mutex;
+    std::vector<int> seen(1000, 0);
+    log.scan(
+        100,
+        900,
+        [&](std::size_t number, const edn::value_t& value)
+        {
+            EXPECT_EQ(value, record(static_cast<int>(number)));
+            const std::lock_guard<std::mutex> lock{ mutex };
+            ++seen[number];
+        },
+        &pool);
+    for (std::size_t i = 0; i < seen.size(); ++i)
+    {
+        ASSERT_EQ(seen[i], i >= 100 && i < 900 ? 1 : 0) << i;
+    }
+    const auto fail_at_500 = [](std::size_t number, const edn::value_t&)
+    {
+        if (number == 500)
+        {
+            throw std::runtime_error{ "stop" };
+        }
+    };
+    EXPECT_THROW(log.scan(fail_at_500, &pool), std::runtime_error);
+}
+
+TEST(record_log, finds_records_by_key)
+{
+    const log_directory_t directory;
+    {
+        edn::record_log log{ directory.path(), keyed(16) };
+        for (int i = 0; i < 500; ++i)
+        {
+            log.append(record(2 * i));
+        }
+        EXPECT_THROW(log.append(record(0)), std::runtime_error);
+        EXPECT_EQ(log.lower_bound(edn::value_t{ 0 }), 0);
+        EXPECT_EQ(log.lower_bound(edn::value_t{ 401 }), 201);
+    }
+    std::filesystem::remove(directory.path().string() + ".keys");
+    edn::record_log log{ directory.path(), keyed(16) };
+    EXPECT_EQ(log.lower_bound(edn::value_t{ 402 }), 201);
+    EXPECT_EQ(log.lower_bound(edn::value_t{ 998 }), 499);
+    EXPECT_EQ(log.lower_bound(edn::value_t{ 999 }), 500);
+    EXPECT_THROW(log.append(record(997)), std::runtime_error);
+    EXPECT_EQ(log.append(record(998)), 500);
+}
+
+TEST(record_log, recovers_torn_tail)
+{
+    const log_directory_t directory;
+    {
+        edn::record_log log{ directory.path() };
+        for (int i = 0; i < 10; ++i)
+        {
+            log.append(record(i));
+        }
+    }
+    // Records written without their index entries, a torn record and a torn index entry.
+    const std::string torn = "{:seq 12 :text \"li";
+    append_raw(directory.path(), edn::str(record(10), "\n", record(11), "\n", torn));
+    append_raw(directory.path().string() + ".idx", "\x01\x02\x03");
+    {
+        edn::record_log log{ directory.path() };
+        EXPECT_EQ(log.size(), 12);
+        EXPECT_EQ(log.recovered_records(), 2);
+        EXPECT_EQ(log.truncated_bytes(), torn.size());
+        EXPECT_EQ(log.read(11), record(11));
+        log.append(record(12));
+    }
+    edn::record_log log{ directory.path() };
+    EXPECT_EQ(log.size(), 13);
+    EXPECT_EQ(log.recovered_records(), 0);
+    EXPECT_EQ(log.truncated_bytes(), 0);
+    EXPECT_EQ(log.read(12), record(12));
+}
+
+TEST(record_log, rebuilds_lost_index)
+{
+    const log_directory_t directory;
+    {
+        edn::record_log log{ directory.path() };
+        for (int i = 0; i < 20; ++i)
+        {
+            log.append(record(i));
+        }
+    }
+    std::filesystem::remove(directory.path().string() + ".idx");
+    edn::record_log log{ directory.path() };
+    EXPECT_EQ(log.size(), 20);
+    EXPECT_EQ(log.recovered_records(), 20);
+    EXPECT_EQ(log.read(7), record(7));
+}
@@ -0,0 +1,69 @@
+#include <gmock/gmock.h>
+
+#include <edn/shared_document.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "matchers.hpp"
+
+TEST(shared_document, reads_and_publishes_versions)
+{
+    edn::shared_document document{ edn::parse("{:port 80}") };
+    EXPECT_EQ(document.version(), 0);
+    {
+        const auto guard = document.read();
+        EXPECT_THAT(*guard, WhenSerialized(testing::StrEq("{:port 80}")));
+    }
+    document.publish(edn::parse("{:port 81}"));
+    document.update(
+        [](const edn::value_t& current)
+        {
+            edn::map_t next = *current.if_map();
+            next[edn::keyword_t{ "host" }] = "localhost";
+            return next;
+        });
+    EXPECT_EQ(document.version(), 2);
+    EXPECT_EQ(document.read().version(), 2);
+    EXPECT_EQ(document.snapshot(), edn::parse("{:port 81 :host \"localhost\"}"));
+}
+
+TEST(shared_document, readers_see_consistent_versions)
+{
+    edn::deferred_reclaimer reclaimer{};
+    edn::shared_document document{ edn::vector_t{ 0, 0, 0 }, &reclaimer };
+    std::atomic<bool> done = false;
+    std::atomic<int> inconsistent = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back(
+            [&]()
+            {
+                std::uint64_t last = 0;
+                while (!done)
+                {
+                    const auto guard = document.read();
+                    const edn::vector_t& items = *guard->if_vector();
+                    const bool same = items[0] == items[1] && items[1] == items[2];
+                    if (!same || guard.version() < last || *items[0].if_integer() != static_cast<int>(guard.version()))
+                    {
+                        ++inconsistent;
+                    }
+                    last = guard.version();
+                }
+            });
+    }
+    for (int n = 1; n <= 100; ++n)
+    {
+        document.publish(edn::vector_t{ n, n, n });
+    }
+    done = true;
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+    reclaimer.drain();
+    EXPECT_EQ(inconsistent, 0);
+    EXPECT_EQ(reclaimer.statistics().retired + reclaimer.statistics().destroyed_inline, 100);
+}
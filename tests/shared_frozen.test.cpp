@@ -0,0 +1,97 @@
+#include <gmock/gmock.h>
+
+#include <edn/shared_frozen.hpp>
+
+#if EDN_HAS_SHARED_FROZEN
+
+#include <sys/wait.h>
+
+namespace
+{
+
+class shared_name_t
+{
+public:
+    shared_name_t() : m_name(edn::str("/edn-test-", ::getpid())) { edn::shared_frozen_publisher::remove(m_name); }
+
+    ~shared_name_t() { edn::shared_frozen_publisher::remove(m_name); }
+
+    const std::string& get() const { return m_name; }
+
+private:
+    std::string m_name;
+};
+
+edn::value_t document(int version)
+{
+    return edn::parse(edn::str("{:version ", version, " :ids [1 2 3] :name \"reference data\"}"));
+}
+
+}  // namespace
+
+TEST(shared_frozen, reader_sees_published_versions)
+{
+    const shared_name_t name;
+    edn::shared_frozen_reader reader{ name.get() };
+    EXPECT_EQ(reader.current(), nullptr);
+
+    edn::shared_frozen_publisher publisher{ name.get() };
+    EXPECT_EQ(reader.current(), nullptr);
+    EXPECT_EQ(publisher.publish(document(1)), 1);
+
+    const std::shared_ptr<const edn::shared_frozen_snapshot> first = reader.current();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->version(), 1);
+    EXPECT_EQ(first->root().thaw(), document(1));
+    EXPECT_EQ(reader.current(), first);
+
+    EXPECT_EQ(publisher.publish(document(2)), 2);
+    const std::shared_ptr<const edn::shared_frozen_snapshot> second = reader.current();
+    EXPECT_EQ(second->version(), 2);
+    EXPECT_EQ(second->root().thaw(), document(2));
+    // The replaced version stays readable while its snapshot is held.
+    EXPECT_EQ(first->root().thaw(), document(1));
+}
+
+TEST(shared_frozen, reader_skips_versions_replaced_before_mapping)
+{
+    const shared_name_t name;
+    edn::shared_frozen_publisher publisher{ name.get() };
+    edn::shared_frozen_reader reader{ name.get() };
+    for (int i = 1; i <= 5; ++i)
+    {
+        publisher.publish(document(i));
+    }
+    EXPECT_EQ(reader.current()->root().thaw(), document(5));
+    edn::shared_frozen_publisher next_publisher{ name.get() };
+    EXPECT_EQ(next_publisher.version(), 5);
+    EXPECT_EQ(next_publisher.publish(document(6)), 6);
+    EXPECT_EQ(reader.current()->version(), 6);
+}
+
+TEST(shared_frozen, shares_document_with_other_processes)
+{
+    const shared_name_t name;
+    edn::shared_frozen_publisher publisher{ name.get() };
+    publisher.publish(document(1));
+    const pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        edn::shared_frozen_reader reader{ name.get() };
+        const auto snapshot = reader.current();
+        ::_exit(snapshot && snapshot->root().thaw() == document(1) ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(shared_frozen, rejects_invalid_names)
+{
+    EXPECT_THROW(edn::shared_frozen_reader{ "no-slash" }, std::runtime_error);
+    EXPECT_THROW(edn::shared_frozen_publisher{ "/a/b" }, std::runtime_error);
+}
+
+#endif
@@ -0,0 +1,154 @@
+#include <gmock/gmock.h>
+
+#include <edn/watch.hpp>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "matchers.hpp"
+
+namespace
+{
+
+class watched_file_t
+{
+public:
+    explicit watched_file_t(const std::string& name)
+        : m_directory(std::filesystem::temp_directory_path() / ("edn-watch-" + name))
+    {
+        std::filesystem::remove_all(m_directory);
+        std::filesystem::create_directories(m_directory);
+    }
+
+    ~watched_file_t() { std::filesystem::remove_all(m_directory); }
+
+    std::filesystem::path path() const { return m_directory / "config.edn"; }
+
+    void write(const std::string& text) const
+    {
+        std::ofstream{ path(), std::ios::trunc } << text;
+    }
+
+    // Writes a sibling file and renames it over the watched one.
+    void replace(const std::string& text) const
+    {
+        const std::filesystem::path temporary = m_directory / "config.edn.tmp";
+        std::ofstream{ temporary, std::ios::trunc } << text;
+        std::filesystem::rename(temporary, path());
+    }
+
+private:
+    std::filesystem::path m_directory;
+};
+
+struct recorder_t
+{
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::vector<edn::value_t> m_values;
+    std::vector<edn::edit_script_t> m_edits;
+    std::vector<std::string> m_errors;
+
+    edn::file_watcher::callback_type callback()
+    {
+        return [this](const edn::value_t& value, const edn::edit_script_t& edits)
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_values.push_back(value);
+            m_edits.push_back(edits);
+            m_changed.notify_all();
+        };
+    }
+
+    edn::watch_options_t options()
+    {
+        edn::watch_options_t result = {};
+        result.debounce = std::chrono::milliseconds{ 20 };
+        result.poll_interval = std::chrono::milliseconds{ 20 };
+        result.on_error = [this](const std::exception& error)
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_errors.push_back(error.what());
+            m_changed.notify_all();
+        };
+        return result;
+    }
+
+    bool wait_for(std::size_t values, std::size_t errors = 0)
+    {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        return m_changed.wait_for(
+            lock,
+            std::chrono::seconds{ 5 },
+            [&]() { return m_values.size() >= values && m_errors.size() >= errors; });
+    }
+};
+
+}  // namespace
+
+TEST(watch, reports_changed_versions)
+{
+    const watched_file_t file{ "changes" };
+    file.write("{:port 80 :host \"a\"}");
+    recorder_t recorder;
+    const auto watcher = edn::watch(file.path(), recorder.callback(), recorder.options());
+    ASSERT_TRUE(recorder.wait_for(1));
+    EXPECT_EQ(recorder.m_values[0], edn::parse("{:port 80 :host \"a\"}"));
+
+    file.write("{:port 81 :host \"a\"}");
+    ASSERT_TRUE(recorder.wait_for(2));
+    EXPECT_EQ(recorder.m_values[1], edn::parse("{:port 81 :host \"a\"}"));
+    EXPECT_THAT(
+        recorder.m_edits[1],
+        testing::ElementsAre(edn::edit_t{ edn::edit_kind_t::replace, *edn::parse("[:port]").if_vector(), 81 }));
+
+    file.replace("{:port 82 :host \"a\"}");
+    ASSERT_TRUE(recorder.wait_for(3));
+    EXPECT_EQ(recorder.m_values[2], edn::parse("{:port 82 :host \"a\"}"));
+}
+
+TEST(watch, skips_unchanged_content_and_parse_errors)
+{
+    const watched_file_t file{ "unchanged" };
+    file.write("[1 2 3]");
+    recorder_t recorder;
+    const auto watcher = edn::watch(file.path(), recorder.callback(), recorder.options());
+    ASSERT_TRUE(recorder.wait_for(1));
+
+    file.write("[1 2   3]  ; same value");
+    file.write("[1 2");
+    ASSERT_TRUE(recorder.wait_for(1, 1));
+    file.write("[1 2 4]");
+    ASSERT_TRUE(recorder.wait_for(2));
+    EXPECT_EQ(recorder.m_values.back(), edn::parse("[1 2 4]"));
+    EXPECT_EQ(watcher->reloads(), 2);
+}
+
+TEST(watch, publishes_into_shared_document)
+{
+    const watched_file_t file{ "document" };
+    file.write("{:version 1}");
+    edn::shared_document document;
+    recorder_t recorder;
+    {
+        const auto watcher = edn::watch(file.path(), document, recorder.options());
+        const auto published = [&](int version)
+        {
+            for (int i = 0; i < 500; ++i)
+            {
+                if (document.snapshot() == edn::parse(edn::str("{:version ", version, "}")))
+                {
+                    return true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+            }
+            return false;
+        };
+        ASSERT_TRUE(published(1));
+        file.write("{:version 2}");
+        ASSERT_TRUE(published(2));
+    }
+    EXPECT_EQ(document.version(), 2);
+}
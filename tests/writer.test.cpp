@@ -0,0 +1,128 @@
+#include <gmock/gmock.h>
+
+#include <edn/writer.hpp>
+#include <sstream>
+
+namespace
+{
+
+template <class Func>
+std::string write(Func func, edn::writer_options_t options = {})
+{
+    std::ostringstream os;
+    {
+        edn::stream_writer writer{ os, options };
+        func(writer);
+        EXPECT_TRUE(writer.complete());
+    }
+    return os.str();
+}
+
+}  // namespace
+
+TEST(writer, writes_nested_collections)
+{
+    const std::string text = write(
+        [](edn::stream_writer& w)
+        {
+            w.begin_map()
+                .key("id")
+                .value(42)
+                .key("name")
+                .value("a \"quoted\"\nline")
+                .key("score")
+                .value(2.0)
+                .key("tags")
+                .begin_set()
+                .keyword("a")
+                .symbol("b")
+                .end_set()
+                .key(edn::value_t{ 7 })
+                .begin_list()
+                .value('x')
+                .value(' ')
+                .value(edn::nil_t{})
+                .value(true)
+                .end_list()
+                .key("at")
+                .tag("inst")
+                .value("2024-01-01")
+                .key("empty")
+                .begin_vector()
+                .end_vector()
+                .end_map();
+        });
+    EXPECT_EQ(
+        text,
+        "{:id 42 :name \"a \\\"quoted\\\"\\nline\" :score 2.0 :tags #{:a b} 7 (\\x \\space nil true) "
+        ":at #inst \"2024-01-01\" :empty []}\n");
+    EXPECT_EQ(edn::parse(text),
+              edn::parse("{:id 42 :name \"a \\\"quoted\\\"\\nline\" :score 2.0 :tags #{:a b} 7 (\\x \\space nil true) "
+                         ":at #inst \"2024-01-01\" :empty []}"));
+}
+
+TEST(writer, writes_top_level_values_one_per_line)
+{
+    EXPECT_EQ(write([](edn::stream_writer& w) { w.value(1).keyword("k").begin_vector().value(-2).end_vector(); }),
+              "1\n:k\n[-2]\n");
+}
+
+TEST(writer, writes_values)
+{
+    const edn::value_t value = edn::parse("{:a [1 2.5 \"s\" (x 'y)] :b #{:c} :d #tag {:e nil}}");
+    const std::string text = write([&](edn::stream_writer& w) { w.begin_vector().value(value).value(0.1).end_vector(); });
+    EXPECT_EQ(edn::parse(text), (edn::vector_t{ value, edn::value_t{ 0.1 } }));
+}
+
+TEST(writer, pretty_layout)
+{
+    edn::writer_options_t options = {};
+    options.pretty = true;
+    const std::string text = write(
+        [](edn::stream_writer& w)
+        {
+            w.begin_map().key("a").begin_vector().value(1).value(edn::parse("[2 {:b 3}]")).end_vector();
+            w.key("c").begin_map().end_map().end_map();
+        },
+        options);
+    EXPECT_EQ(text, "{\n  :a [\n    1\n    [\n      2\n      {\n        :b 3\n      }\n    ]\n  ]\n  :c {}\n}\n");
+    EXPECT_EQ(edn::parse(text), edn::parse("{:a [1 [2 {:b 3}]] :c {}}"));
+}
+
+TEST(writer, rejects_invalid_structure)
+{
+    std::ostringstream os;
+    edn::stream_writer writer{ os };
+    EXPECT_THROW(writer.end_vector(), std::runtime_error);
+    EXPECT_THROW(writer.key("a"), std::runtime_error);
+    writer.begin_map();
+    EXPECT_THROW(writer.value(1), std::runtime_error);
+    EXPECT_THROW(writer.begin_vector(), std::runtime_error);
+    EXPECT_THROW(writer.tag("inst"), std::runtime_error);
+    writer.key("a");
+    EXPECT_THROW(writer.key("b"), std::runtime_error);
+    EXPECT_THROW(writer.end_map(), std::runtime_error);
+    writer.begin_vector();
+    EXPECT_THROW(writer.end_map(), std::runtime_error);
+    EXPECT_THROW(writer.value(std::nan("")), std::runtime_error);
+    writer.end_vector().end_map();
+    EXPECT_TRUE(writer.complete());
+}
+
+TEST(writer, flushes_large_output_in_chunks)
+{
+    edn::writer_options_t options = {};
+    options.buffer_size = 1024;
+    std::ostringstream os;
+    edn::stream_writer writer{ os, options };
+    writer.begin_vector();
+    for (int i = 0; i < 10000; ++i)
+    {
+        writer.begin_map().key("id").value(i).key("value").value(i * 0.5).end_map();
+    }
+    EXPECT_GT(os.str().size(), 100000);
+    writer.end_vector().flush();
+    const edn::value_t value = edn::parse(os.str());
+    ASSERT_EQ(value.if_vector()->size(), 10000);
+    EXPECT_EQ((*value.if_vector())[9999], edn::parse("{:id 9999 :value 4999.5}"));
+}
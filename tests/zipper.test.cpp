@@ -0,0 +1,40 @@
+#include <gmock/gmock.h>
+
+#include <edn/zipper.hpp>
+
+#include "matchers.hpp"
+
+TEST(zipper, edits_leaf_and_rebuilds_spine)
+{
+    using namespace edn::literals;
+    edn::zipper_t zipper{ edn::parse("{:servers [{:host \"a\" :port 80} {:host \"b\" :port 81}] :debug false}") };
+    zipper.down("servers"_kw).down(1).down("port"_kw).replace(8081);
+    EXPECT_EQ(zipper.depth(), 3);
+    EXPECT_THAT(*zipper.key(), edn::value_t{ "port"_kw });
+    zipper.up().left();
+    EXPECT_THAT(zipper.index(), 0);
+    EXPECT_THAT(
+        std::move(zipper).commit(),
+        WhenSerialized(testing::StrEq(R"({:servers [{:host "a" :port 80} {:host "b" :port 8081}] :debug false})")));
+}
+
+TEST(zipper, inserts_and_removes_siblings)
+{
+    edn::zipper_t zipper{ edn::parse("(1 [2 3] 4)") };
+    zipper.down(1).insert_left(10).insert_right(20).down().remove();
+    EXPECT_THAT(zipper.node(), WhenSerialized(testing::StrEq("[3]")));
+    zipper.append_child(30).edit([](edn::value_t v) { return edn::list_t{ std::move(v) }; });
+    EXPECT_TRUE(zipper.has_left());
+    EXPECT_TRUE(zipper.has_right());
+    EXPECT_THAT(std::move(zipper).commit(), WhenSerialized(testing::StrEq("(1 10 ([3 30]) 20 4)")));
+}
+
+TEST(zipper, reports_invalid_moves)
+{
+    edn::zipper_t zipper{ edn::parse("[1]") };
+    EXPECT_THROW(zipper.up(), std::logic_error);
+    EXPECT_THROW(zipper.down(1), std::out_of_range);
+    zipper.down();
+    EXPECT_THROW(zipper.right(), std::out_of_range);
+    EXPECT_THROW(zipper.down(), std::runtime_error);
+}